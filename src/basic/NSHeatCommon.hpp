@@ -195,13 +195,74 @@ struct PrismThermalSimulationSetup
     BOOST_HANA_DEFINE_STRUCT(PrismThermalSimulationSetup,
         (Vec<FCoord3D>, monitors),
         (TempUnit, envTemperature),
-        (Index, maxIteration)
+        (Index, maxIteration),
+        (Float, duration),// transient only, unit: s
+        (Float, timeStep)// transient only, unit: s
     );
     PrismThermalSimulationSetup()
     {
         NS_INIT_HANA_STRUCT(*this);
         envTemperature = TempUnit(25, TempUnit::Unit::Celsius);
         maxIteration = 10;
+        duration = 1;
+        timeStep = 1e-2;
+    }
+#ifdef NANO_BOOST_SERIALIZATION_SUPPORT
+    friend class boost::serialization::access;
+    template <typename Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+        NS_UNUSED(version);
+        NS_SERIALIZATION_HANA_STRUCT(ar, *this);
+    }
+#endif//NANO_BOOST_SERIALIZATION_SUPPORT
+};
+
+struct ThermalNetworkLinearSolverSettings
+{
+    enum class Solver { CG, LDLT, SCHUR, SELL_CG };
+    enum class Preconditioner { JACOBI, INCOMPLETE_CHOLESKY, SSOR, AMG, LINE };
+    enum class Smoother { JACOBI, CHEBYSHEV };
+    enum class Ordering { NATURAL, RCM, HILBERT, NESTED_DISSECTION };
+    BOOST_HANA_DEFINE_STRUCT(ThermalNetworkLinearSolverSettings,
+        (Solver, solver),
+        (Ordering, ordering),// matrix row order of the network built by the prism builders
+        (Preconditioner, preconditioner),// CG only, SELL_CG is jacobi preconditioned
+        (bool, matrixFree),// CG on the network face table without assembling G, jacobi or line preconditioner only
+        (bool, mixedPrecision),// float factorization and inner solves, refined to tolerance with double residuals, every solve on a Float64 network (static, transient, PRIMA basis), the prism solvers build Float64 networks for it in static P-T only, not with matrixFree
+        (Float, tolerance),// relative residual
+        (size_t, maxIter),// 0: 2 x matrix size
+        (size_t, subdomains),// schur complement solver only, 0: by matrix size
+        (size_t, sellSigma),// SELL_CG only, rows sorted by length within windows of this size
+        (bool, pipelined),// SELL_CG only, pipelined recurrences with one fused reduction per iteration
+        (size_t, icFillLevel),// level of fill-in kept by incomplete cholesky
+        (Float, icShift),// initial diagonal shift of incomplete cholesky on breakdown
+        (Float, ssorOmega),// relaxation factor of ssor, range (0, 2)
+        (Smoother, amgSmoother),
+        (size_t, amgSmoothSteps),// jacobi sweeps or chebyshev degree per pre/post smoothing
+        (size_t, amgCoarseSize),// hierarchy stops below this size and solves directly
+        (Float, amgStrength)// strength of connection threshold of aggregation
+    );
+    ThermalNetworkLinearSolverSettings()
+    {
+        NS_INIT_HANA_STRUCT(*this);
+        solver = Solver::CG;
+        ordering = Ordering::NATURAL;
+        preconditioner = Preconditioner::JACOBI;
+        matrixFree = false;
+        mixedPrecision = false;
+        tolerance = 1e-6;
+        maxIter = 0;
+        subdomains = 0;
+        sellSigma = 256;
+        pipelined = false;
+        icFillLevel = 0;
+        icShift = 1e-3;
+        ssorOmega = 1.2;
+        amgSmoother = Smoother::JACOBI;
+        amgSmoothSteps = 2;
+        amgCoarseSize = 500;
+        amgStrength = 0.08;
     }
 #ifdef NANO_BOOST_SERIALIZATION_SUPPORT
     friend class boost::serialization::access;
@@ -216,23 +277,78 @@ struct PrismThermalSimulationSetup
 
 struct ThermalNetworkStaticSolverSettings
 {
+    enum class Method { PICARD, NEWTON, ANDERSON };//NEWTON: full jacobian from the temperature slopes of power and conductivity
     BOOST_HANA_DEFINE_STRUCT(ThermalNetworkStaticSolverSettings,
+        (Method, method),// P-T coupling iteration
         (bool, maximumRes),
         (bool, dumpHotmap),
         (bool, dumpResult),
+        (bool, warmStart),// start each linear solve from previous P-T iterate
+        (bool, condenseChains),// eliminate series node chains such as bonding wire segments, P-T iterations only
         (Float, residual),
+        (Float, forcingTerm),// inexact P-T iteration, linear tolerance = forcingTerm * residual / max T, 0: fixed tolerance, the converged iterate is re-solved at full tolerance
         (Index, maxIter),
+        (size_t, andersonDepth),// history depth of anderson mixing
         (Vec<Index>, probs),
-        (TempUnit, envT)
+        (TempUnit, envT),
+        (ThermalNetworkLinearSolverSettings, linearSettings)
     );
     ThermalNetworkStaticSolverSettings()
     {
         NS_INIT_HANA_STRUCT(*this);
+        method = Method::PICARD;
         maximumRes = true;
         dumpHotmap = true;
         dumpResult = true;
+        warmStart = true;
+        condenseChains = false;
         residual = 1e-1;
+        forcingTerm = 1e-1;
         maxIter = 10;
+        andersonDepth = 5;
+        envT = TempUnit(25, TempUnit::Unit::Celsius);
+    }
+#ifdef NANO_BOOST_SERIALIZATION_SUPPORT
+    friend class boost::serialization::access;
+    template <typename Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+        NS_UNUSED(version);
+        NS_SERIALIZATION_HANA_STRUCT(ar, *this);
+    }
+#endif//NANO_BOOST_SERIALIZATION_SUPPORT
+};
+
+struct ThermalNetworkTransientSolverSettings
+{
+    enum class Method { BACKWARD_EULER, CRANK_NICOLSON, TR_BDF2 };
+    BOOST_HANA_DEFINE_STRUCT(ThermalNetworkTransientSolverSettings,
+        (Method, method),// crank nicolson may ring on steps much larger than the smallest RC constant, TR_BDF2 is L-stable with adaptive steps
+        (bool, dumpResult),// stream probe temperatures of every step to the binary transient.bin, see TransientResultWriter
+        (size_t, snapshotInterval),// dumpResult only, full temperature field every this many steps, 0: probes only
+        (Float, duration),// unit: s
+        (Float, step),// unit: s, initial step of TR_BDF2
+        (Float, minStep),// TR_BDF2 only, unit: s
+        (Float, maxStep),// TR_BDF2 only, unit: s, 0: unlimited, a grown step may then skip an excitation pulse not listed in breakpoints
+        (Vec<Float>, breakpoints),// TR_BDF2 only, unit: s, excitation edges, steps end on them and restart from step
+        (Float, tolerance),// TR_BDF2 only, local truncation error per step, unit: K
+        (Float, stepChangeRatio),// TR_BDF2 only, proposed steps within this ratio of the current step keep it and its factorization
+        (size_t, reducedOrder),// 0: full network, > 0: PRIMA reduced model of this order from the power scenarios to probs, step only samples
+        (Vec<Index>, probs),
+        (TempUnit, envT),
+        (ThermalNetworkLinearSolverSettings, linearSettings)
+    );
+    ThermalNetworkTransientSolverSettings()
+    {
+        NS_INIT_HANA_STRUCT(*this);
+        method = Method::BACKWARD_EULER;
+        dumpResult = true;
+        duration = 1;
+        step = 1e-2;
+        minStep = 1e-9;
+        maxStep = 0;
+        tolerance = 1e-2;
+        stepChangeRatio = 1.5;
         envT = TempUnit(25, TempUnit::Unit::Celsius);
     }
 #ifdef NANO_BOOST_SERIALIZATION_SUPPORT
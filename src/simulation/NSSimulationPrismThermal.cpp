@@ -17,9 +17,23 @@ Arr2<Float> PrismThermalSimulation::RunStatic(Vec<Float> &temperature) const
     return solver.Solve(temperature);
 }
 
+Vec<Arr2<Float>> PrismThermalSimulation::RunStaticBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const
+{
+    solver::PrismThermalNetworkStaticSolver solver(m_model);
+    solver.settings.dumpHotmap = false;
+    solver.settings.dumpResult = false;
+    m_model->SearchElementIndices(m_setup.monitors, solver.settings.probs);
+    return solver.SolveBatch(ratios, temperatures);
+}
+
 Arr2<Float> PrismThermalSimulation::RunTransient(CRef<ThermalTransientExcitation> excitation) const
 {
-    return {INVALID_FLOAT, INVALID_FLOAT}; //todo
+    solver::PrismThermalNetworkTransientSolver solver(m_model);
+    solver.settings.duration = m_setup.duration;
+    solver.settings.step = m_setup.timeStep;
+    m_model->SearchElementIndices(m_setup.monitors, solver.settings.probs);
+    Vec<Float> temperatures;
+    return solver.Solve(excitation, temperatures);
 }
 
 PrismStackupThermalSimulation::PrismStackupThermalSimulation(CPtr<model::PrismStackupThermalModel> model, CRef<PrismThermalSimulationSetup> setup)
@@ -35,9 +49,23 @@ Arr2<Float> PrismStackupThermalSimulation::RunStatic(Vec<Float> &temperature) co
     return solver.Solve(temperature);   
 }
 
+Vec<Arr2<Float>> PrismStackupThermalSimulation::RunStaticBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const
+{
+    solver::PrismStackupThermalNetworkStaticSolver solver(m_model);
+    solver.settings.dumpHotmap = false;
+    solver.settings.dumpResult = false;
+    m_model->SearchElementIndices(m_setup.monitors, solver.settings.probs);
+    return solver.SolveBatch(ratios, temperatures);
+}
+
 Arr2<Float> PrismStackupThermalSimulation::RunTransient(CRef<ThermalTransientExcitation> excitation) const
 {
-    return {INVALID_FLOAT, INVALID_FLOAT}; //todo
+    solver::PrismStackupThermalNetworkTransientSolver solver(m_model);
+    solver.settings.duration = m_setup.duration;
+    solver.settings.step = m_setup.timeStep;
+    m_model->SearchElementIndices(m_setup.monitors, solver.settings.probs);
+    Vec<Float> temperatures;
+    return solver.Solve(excitation, temperatures);
 }
 
 } // namespace nano::heat::simulation
\ No newline at end of file
@@ -16,6 +16,9 @@ public:
     PrismThermalSimulation(CPtr<model::PrismThermalModel> model, CRef<PrismThermalSimulationSetup> setup);
 
     Arr2<Float> RunStatic(Vec<Float> & temperature) const;
+    /// ratios[case][scenario] scales scenario power, returns [min, max] and monitor temperatures of each case
+    Vec<Arr2<Float>> RunStaticBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const;
+    /// implicit time stepping over setup duration, returns [min, max] temperature over the run
     Arr2<Float> RunTransient(CRef<ThermalTransientExcitation> excitation) const;
 private:
     CPtr<model::PrismThermalModel> m_model;
@@ -28,6 +31,9 @@ public:
     PrismStackupThermalSimulation(CPtr<model::PrismStackupThermalModel> model, CRef<PrismThermalSimulationSetup> setup);
 
     Arr2<Float> RunStatic(Vec<Float> & temperature) const;
+    /// ratios[case][scenario] scales scenario power, returns [min, max] and monitor temperatures of each case
+    Vec<Arr2<Float>> RunStaticBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const;
+    /// implicit time stepping over setup duration, returns [min, max] temperature over the run
     Arr2<Float> RunTransient(CRef<ThermalTransientExcitation> excitation) const;
 private:
     CPtr<model::PrismStackupThermalModel> m_model;
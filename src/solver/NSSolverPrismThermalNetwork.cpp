@@ -1,7 +1,11 @@
 #include "NSSolverPrismThermalNetwork.h"
 #include "utils/NSPrismStackupThermalNetworkBuilder.h"
 #include "utils/NSPrismThermalNetworkBuilder.h"
+#include "utils/NSAndersonMixing.hpp"
+#include "utils/NSTransientResultWriter.hpp"
+#include "network/NSThermalNetworkSuperposition.hpp"
 #include "network/NSThermalNetworkSolver.hpp"
+#include "network/NSThermalNetworkMOR.hpp"
 #include "model/NSModelPrismStackupThermal.h"
 #include "model/NSModelPrismThermal.h"
 #include "model/NSModelTraits.hpp"
@@ -18,6 +22,9 @@ Pair<Set<Index>, Vec<Index>> GetProbsAndPermutation(const Vec<Index> & indices)
     return std::make_pair(probs, permutation);
 }
 
+/// loosest linear tolerance used by inexact P-T iterations
+inline static constexpr Float MAX_INEXACT_TOLERANCE = 1e-2;
+
 template <typename Scalar>
 Scalar CalculateResidual(const Vec<Scalar> & v1, const Vec<Scalar> & v2, bool maximumRes)
 {
@@ -31,21 +38,34 @@ Scalar CalculateResidual(const Vec<Scalar> & v1, const Vec<Scalar> & v2, bool ma
     return residual;
 }
 
-template <typename ThermalNetworkBuilder>
-bool ThermalNetworkStaticSolver::Solve(CPtr<typename ThermalNetworkBuilder::ModelType> model, Vec<Scalar> & results) const
+/// the same network builder on another scalar type
+template <typename ThermalNetworkBuilder, typename Scalar>
+struct RebindScalar;
+
+template <template <typename> class ThermalNetworkBuilder, typename From, typename To>
+struct RebindScalar<ThermalNetworkBuilder<From>, To> { using type = ThermalNetworkBuilder<To>; };
+
+/// power maps solved together per batched linear solve
+inline static constexpr size_t BATCH_BLOCK_SIZE = 32;
+/// maximum step halvings of newton line search
+inline static constexpr size_t MAX_LINE_SEARCH = 5;
+
+template <typename ThermalNetworkBuilder, typename Real>
+void ThermalNetworkStaticSolver::SolvePicard(const ThermalNetworkBuilder & builder, size_t maxIter, Vec<Real> & results) const
 {
-    NS_ASSERT(model);
     auto envT = settings.envT.inKelvins();
-    using Model = typename ThermalNetworkBuilder::ModelType;
-    results.assign(model::traits::ThermalModelTraits<Model>::Size(*model), envT);
-    
-    Scalar residual = 0;
+    Real residual = 0;
     size_t iteration = 0;
-    Vec<Scalar> prevRes(results);
-    ThermalNetworkBuilder builder(model);
-    network::ThermalNetworkStaticSolver<Scalar> solver;
-    size_t maxIter = model::traits::ThermalModelTraits<Model>::NeedIteration(*model) ? settings.maxIter : 1;
-    do {
+    Vec<Real> prevRes(results);
+    network::ThermalNetworkStaticSolver<Real> solver(settings.linearSettings);
+    solver.SetCondensation(settings.condenseChains);
+    const Real minTolerance = settings.linearSettings.tolerance;
+    bool inexact = maxIter > 1 && settings.forcingTerm > 0;
+    Real tolerance = inexact ? std::max<Real>(minTolerance, MAX_INEXACT_TOLERANCE) : minTolerance;
+    UPtr<utils::AndersonMixing<Real>> anderson;
+    if (ThermalNetworkStaticSolverSettings::Method::ANDERSON == settings.method && settings.andersonDepth > 0)
+        anderson = std::make_unique<utils::AndersonMixing<Real>>(settings.andersonDepth);
+    for (;;) {
         auto network = builder.Build(prevRes);
         NS_ASSERT(network);
         NS_TRACE(network->msg());
@@ -53,14 +73,118 @@ bool ThermalNetworkStaticSolver::Solve(CPtr<typename ThermalNetworkBuilder::Mode
         NS_TRACE("total joule heat: %1%w", builder.summary.jouleHeat);
         NS_TRACE("intake heat flow: %1%w", builder.summary.iHeatFlow);
         NS_TRACE("outtake heat flow: %1%w", builder.summary.oHeatFlow);
-        solver.Solve(*network, envT, results);
-        std::swap(prevRes, results);
+        solver.SetTolerance(tolerance);
+        solver.Solve(*network, envT, results, settings.warmStart ? &prevRes : nullptr);
+        summary.linearIterations += solver.Summary().iterations;
+        summary.linearResidual = solver.Summary().residual;
+        summary.linearTolerance = tolerance;
+        summary.linearHistory.emplace_back(solver.Summary().iterations);
         residual = CalculateResidual(prevRes, results, settings.maximumRes);
+        if (anderson) anderson->Update(prevRes, results);
+        std::swap(prevRes, results);
+        summary.residual = residual;
+        summary.history.emplace_back(residual);
+        summary.iterations = ++iteration;
+        auto solved = tolerance;
+        if (inexact) {
+            //tighten linear tolerance as P-T residual drops
+            auto maxT = *std::max_element(prevRes.cbegin(), prevRes.cend());
+            tolerance = std::clamp<Real>(settings.forcingTerm * residual / maxT, minTolerance, tolerance);
+        }
+
+        NS_TRACE("P-T iteration: %1%, Residual: %2%", iteration, residual);
+        NS_TRACE("max T: %1%C", TempUnit::Kelvins2Celsius(*std::max_element(prevRes.cbegin(), prevRes.cend())));
+        if (residual <= settings.residual) {
+            //converged on a loose linear solve, one more iteration at full linear tolerance
+            if (solved <= minTolerance) break;
+            tolerance = minTolerance;
+        }
+        else if (--maxIter == 0) break;
+    }
+    std::swap(prevRes, results);//latest iterate
+}
 
-        NS_TRACE("P-T iteration: %1%, Residual: %2%", ++iteration, residual);
+template <typename ThermalNetworkBuilder, typename Real>
+void ThermalNetworkStaticSolver::SolveNewton(const ThermalNetworkBuilder & builder, size_t maxIter, Vec<Real> & results) const
+{
+    auto envT = settings.envT.inKelvins();
+    network::ThermalNetworkStaticSolver<Real> solver(settings.linearSettings);
+    if (settings.condenseChains) NS_TRACE("chain condensation is not applied to newton iterations");
+
+    auto network = builder.Build(results);
+    NS_ASSERT(network);
+    NS_TRACE("total size: %1%", network->MatrixSize());
+    for (size_t i = 0; i < network->NodeSize(); ++i) {
+        if (auto t = (*network)[i].t; network->UNKNOWN_T != t) results[i] = t;
+    }
+    auto norm = network::makeResidual(*network, envT, results).norm();
+    //the builder puts the temperature slopes into the network, so the jacobian needs no extra build,
+    //each line search step builds one trial network and the accepted one is the base network of the next iteration
+    Vec<Real> trial(results.size()), dT;
+    for (size_t iteration = 1; iteration <= maxIter; ++iteration) {
+        solver.SolveNewton(*network, envT, results, dT);
+        summary.linearIterations += solver.Summary().iterations;
+        summary.linearResidual = solver.Summary().residual;
+        summary.linearTolerance = settings.linearSettings.tolerance;
+        summary.linearHistory.emplace_back(solver.Summary().iterations);
+
+        //backtracking on |F|, the last trial is taken if none decreases enough
+        Real alpha = 1, trialNorm = 0;
+        decltype(network) trialNetwork;
+        for (size_t ls = 0; ls <= MAX_LINE_SEARCH; ++ls) {
+            if (ls > 0) alpha /= 2;
+            for (size_t i = 0; i < results.size(); ++i)
+                trial[i] = results[i] + alpha * dT[i];
+            trialNetwork = builder.Build(trial);
+            trialNorm = network::makeResidual(*trialNetwork, envT, trial).norm();
+            if (trialNorm <= (1 - Real(1e-4) * alpha) * norm) break;
+        }
+        auto residual = CalculateResidual(results, trial, settings.maximumRes);
+        std::swap(results, trial);
+        network = std::move(trialNetwork);
+        norm = trialNorm;
+        summary.residual = residual;
+        summary.history.emplace_back(residual);
+        summary.iterations = iteration;
+
+        NS_TRACE("Newton iteration: %1%, Residual: %2%, |F|: %3%, step: %4%", iteration, residual, norm, alpha);
         NS_TRACE("max T: %1%C", TempUnit::Kelvins2Celsius(*std::max_element(results.cbegin(), results.cend())));
-    } while (residual > settings.residual && --maxIter > 0);
+        if (residual <= settings.residual) break;
+    }
+}
 
+template <typename ThermalNetworkBuilder>
+bool ThermalNetworkStaticSolver::Solve(CPtr<typename ThermalNetworkBuilder::ModelType> model, Vec<Scalar> & results) const
+{
+    NS_ASSERT(model);
+    auto envT = settings.envT.inKelvins();
+    using Model = typename ThermalNetworkBuilder::ModelType;
+    results.assign(model::traits::ThermalModelTraits<Model>::Size(*model), envT);
+    
+    summary.Reset();
+    size_t maxIter = model::traits::ThermalModelTraits<Model>::NeedIteration(*model) ? settings.maxIter : 1;
+    auto iterate = [&](const auto & builder, auto & temperatures) {
+        if (ThermalNetworkStaticSolverSettings::Method::NEWTON == settings.method)
+            SolveNewton(builder, maxIter, temperatures);
+        else SolvePicard(builder, maxIter, temperatures);
+    };
+    if (settings.linearSettings.mixedPrecision && not std::is_same_v<Scalar, Float64>) {
+        //networks and residuals in double, only the linear solver works in float
+        typename RebindScalar<ThermalNetworkBuilder, Float64>::type builder(model);
+        builder.SetOrdering(settings.linearSettings.ordering);
+        builder.SetSlopes(ThermalNetworkStaticSolverSettings::Method::NEWTON == settings.method);
+        Vec<Float64> temperatures(results.begin(), results.end());
+        iterate(builder, temperatures);
+        results.assign(temperatures.begin(), temperatures.end());
+    }
+    else {
+        ThermalNetworkBuilder builder(model);
+        builder.SetOrdering(settings.linearSettings.ordering);
+        builder.SetSlopes(ThermalNetworkStaticSolverSettings::Method::NEWTON == settings.method);
+        iterate(builder, results);
+    }
+
+    NS_TRACE("total linear iterations: %1%, last linear residual: %2%", summary.linearIterations, summary.linearResidual);
     if (settings.envT.GetUnit() == TempUnit::Unit::Celsius)
         std::for_each(results.begin(), results.end(), [](auto & t) { t = TempUnit::Kelvins2Celsius(t); });
     
@@ -77,6 +201,222 @@ bool ThermalNetworkStaticSolver::Solve(CPtr<typename ThermalNetworkBuilder::Mode
     return true;
 }
 
+template <typename ThermalNetworkBuilder>
+bool ThermalNetworkStaticSolver::SolveBatch(CPtr<typename ThermalNetworkBuilder::ModelType> model, const Vec<Vec<Float>> & ratios, Vec<Arr2<Float>> & ranges, Vec<Vec<Float>> & temperatures) const
+{
+    NS_ASSERT(model);
+    auto envT = settings.envT.inKelvins();
+    using Model = typename ThermalNetworkBuilder::ModelType;
+    Vec<Scalar> iniT(model::traits::ThermalModelTraits<Model>::Size(*model), envT);
+
+    summary.Reset();
+    ThermalNetworkBuilder builder(model);
+    builder.SetOrdering(settings.linearSettings.ordering);
+    auto network = builder.Build(iniT);
+    NS_ASSERT(network);
+    NS_TRACE("total size: %1%, power maps: %2%", network->MatrixSize(), ratios.size());
+
+    ranges.resize(ratios.size());
+    temperatures.resize(ratios.size());
+    network::ThermalNetworkStaticSolver<Scalar> solver(settings.linearSettings);
+    bool celsius = settings.envT.GetUnit() == TempUnit::Unit::Celsius;
+    auto unit = [celsius](Scalar t) { return celsius ? TempUnit::Kelvins2Celsius(t) : t; };
+    generic::math::la::DenseMatrix<Scalar> hf, results;
+    for (size_t begin = 0; begin < ratios.size(); begin += BATCH_BLOCK_SIZE) {
+        auto cases = std::min(BATCH_BLOCK_SIZE, ratios.size() - begin);
+        hf.resize(network->NodeSize(), cases);
+        for (size_t i = 0; i < network->NodeSize(); ++i) {
+            const auto & node = (*network)[i];
+            for (size_t c = 0; c < cases; ++c) {
+                const auto & ratio = ratios[begin + c];
+                hf(i, c) = node.scen < ratio.size() ? node.hf + node.power * (ratio[node.scen] - 1) : node.hf;//boundary heat flux is not scaled
+            }
+        }
+        solver.Solve(*network, envT, hf, results);
+        summary.linearIterations += solver.Summary().iterations;
+        summary.linearResidual = std::max<Float>(summary.linearResidual, solver.Summary().residual);
+        for (size_t c = 0; c < cases; ++c) {
+            ranges[begin + c] = {unit(results.col(c).minCoeff()), unit(results.col(c).maxCoeff())};
+            auto & probes = temperatures[begin + c];
+            probes.resize(settings.probs.size());
+            for (size_t p = 0; p < settings.probs.size(); ++p)
+                probes[p] = unit(results(settings.probs.at(p), c));
+        }
+    }
+    summary.iterations = 1;
+    NS_TRACE("total linear iterations: %1%, worst linear residual: %2%", summary.linearIterations, summary.linearResidual);
+    return true;
+}
+
+template <typename ThermalNetworkBuilder>
+bool ThermalNetworkStaticSolver::BuildSuperposition(CPtr<typename ThermalNetworkBuilder::ModelType> model, network::ThermalNetworkSuperposition<Scalar> & superposition) const
+{
+    NS_ASSERT(model);
+    auto envT = settings.envT.inKelvins();
+    using Model = typename ThermalNetworkBuilder::ModelType;
+    Vec<Scalar> iniT(model::traits::ThermalModelTraits<Model>::Size(*model), envT);
+
+    summary.Reset();
+    ThermalNetworkBuilder builder(model);
+    builder.SetOrdering(settings.linearSettings.ordering);
+    auto network = builder.Build(iniT);
+    NS_ASSERT(network);
+    superposition.Build(*network, envT, settings.probs, settings.linearSettings);
+    if (settings.envT.GetUnit() == TempUnit::Unit::Celsius)
+        std::for_each(superposition.offset.begin(), superposition.offset.end(), [](auto & t) { t = TempUnit::Kelvins2Celsius(t); });
+    summary.iterations = 1;
+    return true;
+}
+
+template <typename ThermalNetworkBuilder>
+bool ThermalNetworkStaticSolver::SolveAdjoint(CPtr<typename ThermalNetworkBuilder::ModelType> model, Vec<Index> & sources, Vec<Vec<Float>> & transfer) const
+{
+    NS_ASSERT(model);
+    auto envT = settings.envT.inKelvins();
+    using Model = typename ThermalNetworkBuilder::ModelType;
+    Vec<Scalar> iniT(model::traits::ThermalModelTraits<Model>::Size(*model), envT);
+
+    summary.Reset();
+    ThermalNetworkBuilder builder(model);
+    builder.SetOrdering(settings.linearSettings.ordering);
+    auto network = builder.Build(iniT);
+    NS_ASSERT(network);
+    generic::math::la::DenseMatrix<Scalar> matrix;
+    network::ThermalNetworkStaticSolver<Scalar> solver(settings.linearSettings);
+    solver.SolveAdjoint(*network, settings.probs, matrix);
+    summary.iterations = 1;
+    summary.linearIterations = solver.Summary().iterations;
+    summary.linearResidual = solver.Summary().residual;
+
+    sources = network->Sources();
+    transfer.assign(matrix.rows(), Vec<Float>(matrix.cols()));
+    for (Eigen::Index p = 0; p < matrix.rows(); ++p)
+        for (Eigen::Index s = 0; s < matrix.cols(); ++s)
+            transfer[p][s] = matrix(p, s);
+    return true;
+}
+
+template <typename ThermalNetworkBuilder>
+bool ThermalNetworkTransientSolver::Solve(CPtr<typename ThermalNetworkBuilder::ModelType> model, CRef<ThermalTransientExcitation> excitation, Arr2<Float> & range, Vec<Float> & temperatures) const
+{
+    NS_ASSERT(model);
+    NS_ASSERT(settings.step > 0);
+    auto envT = settings.envT.inKelvins();
+    using Model = typename ThermalNetworkBuilder::ModelType;
+    Vec<Scalar> iniT(model::traits::ThermalModelTraits<Model>::Size(*model), envT);
+    if (model::traits::ThermalModelTraits<Model>::NeedIteration(*model))
+        NS_TRACE("transient network is built at envT, temperature dependence is not iterated");
+
+    summary.Reset();
+    ThermalNetworkBuilder builder(model);
+    builder.SetOrdering(settings.linearSettings.ordering);
+    auto network = builder.Build(iniT);
+    NS_ASSERT(network);
+    NS_TRACE("total size: %1%, duration: %2%s, step: %3%s", network->MatrixSize(), settings.duration, settings.step);
+
+    bool celsius = settings.envT.GetUnit() == TempUnit::Unit::Celsius;
+    auto unit = [celsius](Scalar t) { return celsius ? TempUnit::Kelvins2Celsius(t) : t; };
+    //full field snapshots need the full network state
+    auto interval = settings.reducedOrder > 0 ? 0 : settings.snapshotInterval;
+    UPtr<utils::TransientResultWriter> writer;
+    if (settings.dumpResult)
+        writer = std::make_unique<utils::TransientResultWriter>(std::string(nano::CurrentDir()) + "/transient.bin",
+                                                                settings.probs.size(), network->NodeSize(), interval);
+
+    if (settings.reducedOrder > 0) {
+        if (nullptr == reducedModel || not reducedModel->isValid(*network, envT, envT, settings.probs, settings.reducedOrder)) {
+            reducedModel = std::make_shared<network::ThermalNetworkReducedModel<Scalar>>();
+            reducedModel->Build(*network, envT, envT, settings.probs, settings.reducedOrder, settings.linearSettings);
+            summary.factorizations = 1;
+        }
+        summary.reducedOrder = reducedModel->Order();
+        Scalar minT = std::numeric_limits<Scalar>::max(), maxT = -minT;
+        reducedModel->Simulate(excitation, settings.duration, settings.step, [&](Scalar time, const auto & y) {
+            if (time > 0) summary.steps++;
+            if (y.size() > 0) {
+                minT = std::min(minT, y.minCoeff());
+                maxT = std::max(maxT, y.maxCoeff());
+            }
+            temperatures.resize(y.size());
+            for (Eigen::Index p = 0; p < y.size(); ++p)
+                temperatures[p] = unit(y[p]);
+            if (writer) writer->Append(time, temperatures);
+        });
+        NS_TRACE("reduced transient steps: %1%, order: %2%", summary.steps, summary.reducedOrder);
+        if (writer && not writer->Close()) return false;
+        range = {Float(unit(minT)), Float(unit(maxT))};
+        return true;
+    }
+
+    network::ThermalNetworkTransientSolver<Scalar> solver(settings);
+    solver.Initialize(*network, envT, iniT, excitation);
+    Vec<Float> probes(settings.probs.size());
+    Vec<Scalar> field;
+    auto sample = [&] {
+        if (nullptr == writer) return;
+        for (size_t p = 0; p < settings.probs.size(); ++p)
+            probes[p] = unit(solver.Temperature(settings.probs.at(p)));
+        if (not writer->NeedField()) return writer->Append(solver.Time(), probes);
+        solver.Temperatures(field);
+        for (auto & t : field) t = unit(t);
+        writer->Append(solver.Time(), probes, &field);
+    };
+    Scalar minT = envT, maxT = envT;
+    for (size_t i = 0; i < network->NodeSize(); ++i) {
+        if (auto t = (*network)[i].t; network->UNKNOWN_T != t) {
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+    }
+    sample();
+    const Scalar duration = settings.duration;
+    const bool adaptive = ThermalNetworkTransientSolverSettings::Method::TR_BDF2 == settings.method;
+    Scalar step = settings.step;
+    if (adaptive && settings.maxStep > 0) step = std::min<Scalar>(step, settings.maxStep);
+    Vec<Scalar> breakpoints;
+    if (adaptive) breakpoints.assign(settings.breakpoints.begin(), settings.breakpoints.end());
+    std::sort(breakpoints.begin(), breakpoints.end());
+    auto breakpoint = breakpoints.cbegin();
+    while (duration - solver.Time() > Scalar(1e-6) * step) {
+        while (breakpoint != breakpoints.cend() && *breakpoint - solver.Time() <= Scalar(1e-6) * step) ++breakpoint;
+        auto end = breakpoint != breakpoints.cend() ? std::min(duration, *breakpoint) : duration;
+        if (adaptive) {
+            solver.Advance(std::min(step, end - solver.Time()), step);
+            //the excitation changes at the breakpoint, the step restarts small to resolve the edge
+            if (end < duration && end - solver.Time() <= Scalar(1e-6) * step) step = std::min<Scalar>(step, settings.step);
+        }
+        else if (not solver.Step(std::min(step, duration - solver.Time())))
+            NS_TRACE("linear solver not converged at %1%s", solver.Time());
+        summary.steps++;
+        summary.linearIterations += solver.StepSummary().iterations;
+        summary.linearResidual = std::max<Float>(summary.linearResidual, solver.StepSummary().residual);
+        if (solver.State().size() > 0) {
+            minT = std::min(minT, solver.State().minCoeff());
+            maxT = std::max(maxT, solver.State().maxCoeff());
+        }
+        sample();
+    }
+    summary.factorizations = solver.Factorizations();
+    summary.rejections = solver.Rejections();
+    NS_TRACE("transient steps: %1%, rejected: %2%, factorizations: %3%, total linear iterations: %4%",
+        summary.steps, summary.rejections, summary.factorizations, summary.linearIterations);
+    if (writer && not writer->Close()) return false;
+
+    range = {Float(unit(minT)), Float(unit(maxT))};
+    temperatures.resize(settings.probs.size());
+    for (size_t p = 0; p < settings.probs.size(); ++p)
+        temperatures[p] = unit(solver.Temperature(settings.probs.at(p)));
+    return true;
+}
+
+template bool ThermalNetworkTransientSolver::Solve<utils::PrismThermalNetworkBuilder<ThermalNetworkTransientSolver::Scalar>>(CPtr<model::PrismThermalModel> model, CRef<ThermalTransientExcitation> excitation, Arr2<Float> & range, Vec<Float> & temperatures) const;
+template bool ThermalNetworkTransientSolver::Solve<utils::PrismStackupThermalNetworkBuilder<ThermalNetworkTransientSolver::Scalar>>(CPtr<model::PrismStackupThermalModel> model, CRef<ThermalTransientExcitation> excitation, Arr2<Float> & range, Vec<Float> & temperatures) const;
+template bool ThermalNetworkStaticSolver::SolveAdjoint<utils::PrismThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismThermalModel> model, Vec<Index> & sources, Vec<Vec<Float>> & transfer) const;
+template bool ThermalNetworkStaticSolver::SolveAdjoint<utils::PrismStackupThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismStackupThermalModel> model, Vec<Index> & sources, Vec<Vec<Float>> & transfer) const;
+template bool ThermalNetworkStaticSolver::BuildSuperposition<utils::PrismThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismThermalModel> model, network::ThermalNetworkSuperposition<ThermalNetworkStaticSolver::Scalar> & superposition) const;
+template bool ThermalNetworkStaticSolver::BuildSuperposition<utils::PrismStackupThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismStackupThermalModel> model, network::ThermalNetworkSuperposition<ThermalNetworkStaticSolver::Scalar> & superposition) const;
+template bool ThermalNetworkStaticSolver::SolveBatch<utils::PrismThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismThermalModel> model, const Vec<Vec<Float>> & ratios, Vec<Arr2<Float>> & ranges, Vec<Vec<Float>> & temperatures) const;
+template bool ThermalNetworkStaticSolver::SolveBatch<utils::PrismStackupThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismStackupThermalModel> model, const Vec<Vec<Float>> & ratios, Vec<Arr2<Float>> & ranges, Vec<Vec<Float>> & temperatures) const;
 template bool ThermalNetworkStaticSolver::Solve<utils::PrismThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismThermalModel> model, Vec<ThermalNetworkStaticSolver::Scalar> & results) const;
 template bool ThermalNetworkStaticSolver::Solve<utils::PrismStackupThermalNetworkBuilder<ThermalNetworkStaticSolver::Scalar>>(CPtr<model::PrismStackupThermalModel> model, Vec<ThermalNetworkStaticSolver::Scalar> & results) const;
 
@@ -88,7 +428,10 @@ PrismThermalNetworkStaticSolver::PrismThermalNetworkStaticSolver(CPtr<model::Pri
 Arr2<Float> PrismThermalNetworkStaticSolver::Solve(Vec<Float> & temperatures) const
 {
     Vec<Scalar> results;
-    auto res = ThermalNetworkStaticSolver().Solve<utils::PrismThermalNetworkBuilder<Scalar>>(m_model, results);
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.Solve<utils::PrismThermalNetworkBuilder<Scalar>>(m_model, results);
+    summary = solver.summary;
     if (not res) return {INVALID_FLOAT, INVALID_FLOAT};
 
     auto minT = * std::min_element(results.cbegin(), results.cend());
@@ -104,6 +447,35 @@ Arr2<Float> PrismThermalNetworkStaticSolver::Solve(Vec<Float> & temperatures) co
     return {minT, maxT};
 }
 
+Vec<Arr2<Float>> PrismThermalNetworkStaticSolver::SolveBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const
+{
+    Vec<Arr2<Float>> ranges;
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.SolveBatch<utils::PrismThermalNetworkBuilder<Scalar>>(m_model, ratios, ranges, temperatures);
+    summary = solver.summary;
+    if (not res) return {};
+    return ranges;
+}
+
+bool PrismThermalNetworkStaticSolver::BuildSuperposition(network::ThermalNetworkSuperposition<Scalar> & superposition) const
+{
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.BuildSuperposition<utils::PrismThermalNetworkBuilder<Scalar>>(m_model, superposition);
+    summary = solver.summary;
+    return res;
+}
+
+bool PrismThermalNetworkStaticSolver::SolveAdjoint(Vec<Index> & sources, Vec<Vec<Float>> & transfer) const
+{
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.SolveAdjoint<utils::PrismThermalNetworkBuilder<Scalar>>(m_model, sources, transfer);
+    summary = solver.summary;
+    return res;
+}
+
 PrismStackupThermalNetworkStaticSolver::PrismStackupThermalNetworkStaticSolver(CPtr<model::PrismStackupThermalModel> model)
  : m_model(model)
 {
@@ -112,7 +484,10 @@ PrismStackupThermalNetworkStaticSolver::PrismStackupThermalNetworkStaticSolver(C
 Arr2<Float> PrismStackupThermalNetworkStaticSolver::Solve(Vec<Float> & temperatures) const
 {
     Vec<Scalar> results;
-    auto res = ThermalNetworkStaticSolver().Solve<utils::PrismStackupThermalNetworkBuilder<Scalar>>(m_model, results);
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.Solve<utils::PrismStackupThermalNetworkBuilder<Scalar>>(m_model, results);
+    summary = solver.summary;
     if (not res) return {INVALID_FLOAT, INVALID_FLOAT};
 
     auto minT = * std::min_element(results.cbegin(), results.cend());
@@ -128,4 +503,69 @@ Arr2<Float> PrismStackupThermalNetworkStaticSolver::Solve(Vec<Float> & temperatu
     return {minT, maxT};
 }
 
+Vec<Arr2<Float>> PrismStackupThermalNetworkStaticSolver::SolveBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const
+{
+    Vec<Arr2<Float>> ranges;
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.SolveBatch<utils::PrismStackupThermalNetworkBuilder<Scalar>>(m_model, ratios, ranges, temperatures);
+    summary = solver.summary;
+    if (not res) return {};
+    return ranges;
+}
+
+bool PrismStackupThermalNetworkStaticSolver::BuildSuperposition(network::ThermalNetworkSuperposition<Scalar> & superposition) const
+{
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.BuildSuperposition<utils::PrismStackupThermalNetworkBuilder<Scalar>>(m_model, superposition);
+    summary = solver.summary;
+    return res;
+}
+
+bool PrismStackupThermalNetworkStaticSolver::SolveAdjoint(Vec<Index> & sources, Vec<Vec<Float>> & transfer) const
+{
+    ThermalNetworkStaticSolver solver;
+    solver.settings = settings;
+    auto res = solver.SolveAdjoint<utils::PrismStackupThermalNetworkBuilder<Scalar>>(m_model, sources, transfer);
+    summary = solver.summary;
+    return res;
+}
+
+PrismThermalNetworkTransientSolver::PrismThermalNetworkTransientSolver(CPtr<model::PrismThermalModel> model)
+ : m_model(model)
+{
+}
+
+Arr2<Float> PrismThermalNetworkTransientSolver::Solve(CRef<ThermalTransientExcitation> excitation, Vec<Float> & temperatures) const
+{
+    Arr2<Float> range;
+    ThermalNetworkTransientSolver solver;
+    solver.settings = settings;
+    solver.reducedModel = reducedModel;
+    auto res = solver.Solve<utils::PrismThermalNetworkBuilder<ThermalNetworkTransientSolver::Scalar>>(m_model, excitation, range, temperatures);
+    summary = solver.summary;
+    reducedModel = solver.reducedModel;
+    if (not res) return {INVALID_FLOAT, INVALID_FLOAT};
+    return range;
+}
+
+PrismStackupThermalNetworkTransientSolver::PrismStackupThermalNetworkTransientSolver(CPtr<model::PrismStackupThermalModel> model)
+ : m_model(model)
+{
+}
+
+Arr2<Float> PrismStackupThermalNetworkTransientSolver::Solve(CRef<ThermalTransientExcitation> excitation, Vec<Float> & temperatures) const
+{
+    Arr2<Float> range;
+    ThermalNetworkTransientSolver solver;
+    solver.settings = settings;
+    solver.reducedModel = reducedModel;
+    auto res = solver.Solve<utils::PrismStackupThermalNetworkBuilder<ThermalNetworkTransientSolver::Scalar>>(m_model, excitation, range, temperatures);
+    summary = solver.summary;
+    reducedModel = solver.reducedModel;
+    if (not res) return {INVALID_FLOAT, INVALID_FLOAT};
+    return range;
+}
+
 } // namespace nano::heat::solver
\ No newline at end of file
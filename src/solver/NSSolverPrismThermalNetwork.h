@@ -10,25 +10,74 @@ class PrismStackupThermalModel;
 
 namespace solver {
 
+namespace network {
+template <typename Scalar> class ThermalNetworkSuperposition;
+template <typename Scalar> class ThermalNetworkReducedModel;
+} // namespace network
+
+struct ThermalNetworkStaticSolveSummary
+{
+    size_t iterations = 0;//P-T iterations
+    size_t linearIterations = 0;//total linear solver iterations
+    Float residual = 0;//last P-T residual
+    Float linearResidual = 0;//last linear solver relative residual
+    Float linearTolerance = 0;//relative tolerance of the last linear solve
+    Vec<Float> history;//P-T residual of each iteration
+    Vec<size_t> linearHistory;//linear solver iterations of each linear solve
+    void Reset() { *this = ThermalNetworkStaticSolveSummary{}; }
+};
 
 class ThermalNetworkStaticSolver
 {
 public:
     using Scalar = Float32;
     ThermalNetworkStaticSolverSettings settings;
+    mutable ThermalNetworkStaticSolveSummary summary;
 
+    /// with linearSettings.mixedPrecision the P-T iteration runs on Float64 networks and the linear solver factors in float
     template <typename ThermalNetworkBuilder>
     bool Solve(CPtr<typename ThermalNetworkBuilder::ModelType> model, Vec<Scalar> & results) const;
+
+    /// solves many power maps against one network built at envT, ratios[case][scenario] scales the power of that scenario,
+    /// scenarios out of range keep their power, temperature dependence of power and materials is not iterated
+    /// ranges: [min, max] temperature of each case, temperatures: probe temperatures of each case
+    template <typename ThermalNetworkBuilder>
+    bool SolveBatch(CPtr<typename ThermalNetworkBuilder::ModelType> model, const Vec<Vec<Float>> & ratios, Vec<Arr2<Float>> & ranges, Vec<Vec<Float>> & temperatures) const;
+
+    /// adjoint solves, one per probe in settings.probs, of the network built at envT,
+    /// transfer[probe][source] is the temperature rise per watt injected at node sources[source], unit: K/W
+    template <typename ThermalNetworkBuilder>
+    bool SolveAdjoint(CPtr<typename ThermalNetworkBuilder::ModelType> model, Vec<Index> & sources, Vec<Vec<Float>> & transfer) const;
+
+    /// influence of each power scenario on settings.probs from the network built at envT, valid when the model is linear
+    template <typename ThermalNetworkBuilder>
+    bool BuildSuperposition(CPtr<typename ThermalNetworkBuilder::ModelType> model, network::ThermalNetworkSuperposition<Scalar> & superposition) const;
+
+private:
+    /// fixed point iteration, rebuild network with previous temperatures and solve, optionally anderson accelerated
+    template <typename ThermalNetworkBuilder, typename Real>
+    void SolvePicard(const ThermalNetworkBuilder & builder, size_t maxIter, Vec<Real> & results) const;
+    /// newton iteration on the full jacobian from the temperature slopes of the builder, with line search,
+    /// results holds the initial guess on input
+    template <typename ThermalNetworkBuilder, typename Real>
+    void SolveNewton(const ThermalNetworkBuilder & builder, size_t maxIter, Vec<Real> & results) const;
 };
 
 class PrismThermalNetworkStaticSolver
 {
 public:
     ThermalNetworkStaticSolverSettings settings;
+    mutable ThermalNetworkStaticSolveSummary summary;
     using Scalar = ThermalNetworkStaticSolver::Scalar;
     explicit PrismThermalNetworkStaticSolver(CPtr<model::PrismThermalModel> model);
 
     Arr2<Float> Solve(Vec<Float> & temperatures) const;
+    /// batched static solve, see ThermalNetworkStaticSolver::SolveBatch
+    Vec<Arr2<Float>> SolveBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const;
+    /// superposition engine on settings.probs, see ThermalNetworkStaticSolver::BuildSuperposition
+    bool BuildSuperposition(network::ThermalNetworkSuperposition<Scalar> & superposition) const;
+    /// probe x source transfer matrix, see ThermalNetworkStaticSolver::SolveAdjoint
+    bool SolveAdjoint(Vec<Index> & sources, Vec<Vec<Float>> & transfer) const;
 
 private:
     CPtr<model::PrismThermalModel> m_model;
@@ -38,10 +87,76 @@ class PrismStackupThermalNetworkStaticSolver
 {
 public:
     ThermalNetworkStaticSolverSettings settings;
+    mutable ThermalNetworkStaticSolveSummary summary;
     using Scalar = ThermalNetworkStaticSolver::Scalar;
     explicit PrismStackupThermalNetworkStaticSolver(CPtr<model::PrismStackupThermalModel> model);
 
     Arr2<Float> Solve(Vec<Float> & temperatures) const;
+    /// batched static solve, see ThermalNetworkStaticSolver::SolveBatch
+    Vec<Arr2<Float>> SolveBatch(const Vec<Vec<Float>> & ratios, Vec<Vec<Float>> & temperatures) const;
+    /// superposition engine on settings.probs, see ThermalNetworkStaticSolver::BuildSuperposition
+    bool BuildSuperposition(network::ThermalNetworkSuperposition<Scalar> & superposition) const;
+    /// probe x source transfer matrix, see ThermalNetworkStaticSolver::SolveAdjoint
+    bool SolveAdjoint(Vec<Index> & sources, Vec<Vec<Float>> & transfer) const;
+
+private:
+    CPtr<model::PrismStackupThermalModel> m_model;
+};
+
+struct ThermalNetworkTransientSolveSummary
+{
+    size_t steps = 0;//accepted steps
+    size_t rejections = 0;//steps rejected by the local error test of TR_BDF2
+    size_t factorizations = 0;//factorizations or preconditioner setups of C / h + G
+    size_t linearIterations = 0;//total linear solver iterations
+    Float linearResidual = 0;//worst linear solver relative residual
+    size_t reducedOrder = 0;//order of the reduced model, 0: full network
+    void Reset() { *this = ThermalNetworkTransientSolveSummary{}; }
+};
+
+class ThermalNetworkTransientSolver
+{
+public:
+    /// states accumulate over many steps, so networks and states are kept in double
+    using Scalar = Float64;
+    ThermalNetworkTransientSolverSettings settings;
+    mutable ThermalNetworkTransientSolveSummary summary;
+    /// reduced model of the last reducedOrder solve, reused while network topology, values, probs and order match
+    mutable SPtr<network::ThermalNetworkReducedModel<Scalar>> reducedModel;
+
+    /// time stepping from envT on the network built at envT, temperature dependence is not iterated,
+    /// probe temperatures of every step and decimated field snapshots stream to transient.bin when dumpResult, no full field is kept,
+    /// range: [min, max] temperature over all nodes and steps, temperatures: probe temperatures at the end,
+    /// with reducedOrder only probe temperatures exist and range covers the probes
+    template <typename ThermalNetworkBuilder>
+    bool Solve(CPtr<typename ThermalNetworkBuilder::ModelType> model, CRef<ThermalTransientExcitation> excitation, Arr2<Float> & range, Vec<Float> & temperatures) const;
+};
+
+class PrismThermalNetworkTransientSolver
+{
+public:
+    ThermalNetworkTransientSolverSettings settings;
+    mutable ThermalNetworkTransientSolveSummary summary;
+    mutable SPtr<network::ThermalNetworkReducedModel<ThermalNetworkTransientSolver::Scalar>> reducedModel;
+    explicit PrismThermalNetworkTransientSolver(CPtr<model::PrismThermalModel> model);
+
+    /// see ThermalNetworkTransientSolver::Solve, returns the temperature range over the run
+    Arr2<Float> Solve(CRef<ThermalTransientExcitation> excitation, Vec<Float> & temperatures) const;
+
+private:
+    CPtr<model::PrismThermalModel> m_model;
+};
+
+class PrismStackupThermalNetworkTransientSolver
+{
+public:
+    ThermalNetworkTransientSolverSettings settings;
+    mutable ThermalNetworkTransientSolveSummary summary;
+    mutable SPtr<network::ThermalNetworkReducedModel<ThermalNetworkTransientSolver::Scalar>> reducedModel;
+    explicit PrismStackupThermalNetworkTransientSolver(CPtr<model::PrismStackupThermalModel> model);
+
+    /// see ThermalNetworkTransientSolver::Solve, returns the temperature range over the run
+    Arr2<Float> Solve(CRef<ThermalTransientExcitation> excitation, Vec<Float> & temperatures) const;
 
 private:
     CPtr<model::PrismStackupThermalModel> m_model;
@@ -3,7 +3,9 @@
 
 #include "generic/math/MathUtility.hpp"
 #include "generic/circuit/MNA.hpp"
+#include <boost/container_hash/hash.hpp>
 #include <numeric>
+#include <span>
 namespace nano::heat::solver::network {
 
 template <typename Scalar>
@@ -18,9 +20,20 @@ public:
         Scalar t = UNKNOWN_T;//unit: K
         Scalar c = 0;//unit: J/K
         Scalar hf = 0;//unit: W
+        Scalar power = 0;//scenario power, the part of hf scaled by the scenario excitation, unit: W
         Scalar htc = 0;//unit: W/m^2-K
-        HashMap<Index, Scalar> ns;//unit: K/W
+        Scalar slope = 0;//temperature derivative of hf, unit: W/K
     };
+
+    struct Edge
+    {
+        Index n1 = INVALID_INDEX;
+        Index n2 = INVALID_INDEX;//n1 < n2
+        Scalar r = 0;//unit: K/W
+        Scalar dg1 = 0;//derivative of 1 / r on the temperature of n1, unit: W/K^2
+        Scalar dg2 = 0;//derivative of 1 / r on the temperature of n2, unit: W/K^2
+    };
+    using Edges = Vec<Edge>;
     
     explicit ThermalNetwork(size_t nodes)
     {
@@ -29,10 +42,11 @@ public:
 
     bool isSource(Index nid) const
     {
+        NS_ASSERT(isFinalized());
         auto & node = m_nodes[nid];
         if (0 != node.hf) return true;
         if (0 != node.htc) return true;
-        for (auto & [n, r] : node.ns) {
+        for (auto n : Neighbors(nid)) {
             if (m_nodes[n].t != UNKNOWN_T)
                 return true;
         }
@@ -45,11 +59,22 @@ public:
     void SetT(Index node, Scalar t) { m_nodes[node].t = t; }
     Scalar GetT(Index ndoe) const { return m_nodes[ndoe].t; }
 
-    void SetHF(Index node, Scalar hf) { m_nodes[node].hf  = hf; }
-    void AddHF(Index node, Scalar hf) { m_nodes[node].hf += hf; }
+    /// total heat flow, drops the scenario power and its slope
+    void SetHF(Index node, Scalar hf) { m_nodes[node].hf  = hf; m_nodes[node].power = 0; m_nodes[node].slope = 0; UpdateSource(node); }
+    /// heat flow that is not scaled with the scenario, e.g. boundary heat flux
+    void AddHF(Index node, Scalar hf) { m_nodes[node].hf += hf; UpdateSource(node); }
     Scalar GetHF(Index node) const { return m_nodes[node].hf; }
 
-    void SetHTC(Index node, Scalar htc) { m_nodes[node].htc = htc; }
+    /// scenario power, it is part of the heat flow as well
+    void SetPower(Index node, Scalar power) { m_nodes[node].hf += power - m_nodes[node].power; m_nodes[node].power = power; UpdateSource(node); }
+    void AddPower(Index node, Scalar power) { m_nodes[node].hf += power; m_nodes[node].power += power; UpdateSource(node); }
+    Scalar GetPower(Index node) const { return m_nodes[node].power; }
+
+    /// temperature derivative of the heat flow, used by newton iterations only
+    void AddSlope(Index node, Scalar slope) { m_nodes[node].slope += slope; }
+    Scalar GetSlope(Index node) const { return m_nodes[node].slope; }
+
+    void SetHTC(Index node, Scalar htc) { m_nodes[node].htc = htc; UpdateSource(node); }
     Scalar GetHTC(Index node) const { return m_nodes[node].htc; }
 
     void SetC(Index node, Scalar c) { m_nodes[node].c = c; } 
@@ -58,48 +83,166 @@ public:
     void SetScenario(Index node, Index scen) { m_nodes[node].scen = scen; }
     Index GetScenario(Index node) const { return m_nodes[node].scen; }
 
-    void SetR(Index node1, Index node2, Scalar r)
+    /// collect resistor into network edge buffer, parallel resistors are merged in Finalize()
+    void SetR(Index node1, Index node2, Scalar r, Scalar dr1 = 0, Scalar dr2 = 0)
+    {
+        NS_ASSERT(not isFinalized());
+        AddR(m_edges, node1, node2, r, dr1, dr2);
+    }
+
+    /// collect resistor into external edge buffer, used by parallel builders,
+    /// dr1, dr2: derivatives of r on the temperatures of node1 and node2, only newton iterations use them
+    static void AddR(Edges & edges, Index node1, Index node2, Scalar r, Scalar dr1 = 0, Scalar dr2 = 0)
     {
         NS_ASSERT(isValid(r));
+        NS_ASSERT(node1 != node2);
         r = std::max(r, MIN_R);
-        if (node1 > node2) std::swap(node1, node2);
-        auto & n1 = m_nodes[node1];
-        if (auto iter = n1.ns.find(node2); iter != n1.ns.cend())
-            iter->second = 1 / (1 / r + 1 / iter->second);
-        else n1.ns.emplace(node2, r);
+        if (node1 > node2) {
+            std::swap(node1, node2);
+            std::swap(dr1, dr2);
+        }
+        edges.emplace_back(Edge{node1, node2, r, -dr1 / (r * r), -dr2 / (r * r)});
+    }
+
+    void ReserveEdges(size_t size) { m_edges.reserve(size); }
+
+    void AppendEdges(const Edges & edges)
+    {
+        NS_ASSERT(not isFinalized());
+        m_edges.insert(m_edges.end(), edges.begin(), edges.end());
+    }
+
+    /// freeze collected edges into compressed sparse row arrays, each edge is stored in both rows
+    void Finalize()
+    {
+        NS_ASSERT(not isFinalized());
+        std::stable_sort(m_edges.begin(), m_edges.end(), [](const auto & e1, const auto & e2) {
+            return e1.n1 < e2.n1 || (e1.n1 == e2.n1 && e1.n2 < e2.n2);
+        });
+        //merge parallel resistors in insertion order, conductances and their slopes add up
+        size_t edges{0};
+        for (size_t i = 0; i < m_edges.size(); ++i) {
+            if (edges > 0 && m_edges[edges - 1].n1 == m_edges[i].n1 && m_edges[edges - 1].n2 == m_edges[i].n2) {
+                auto & edge = m_edges[edges - 1];
+                edge.r = 1 / (1 / edge.r + 1 / m_edges[i].r);
+                edge.dg1 += m_edges[i].dg1;
+                edge.dg2 += m_edges[i].dg2;
+            }
+            else m_edges[edges++] = m_edges[i];
+        }
+        m_edges.resize(edges);
+        bool slopes = std::any_of(m_edges.cbegin(), m_edges.cend(), [](const auto & e) { return 0 != e.dg1 || 0 != e.dg2; });
+
+        m_offsets.assign(m_nodes.size() + 1, 0);
+        for (const auto & edge : m_edges) {
+            m_offsets[edge.n1 + 1]++;
+            m_offsets[edge.n2 + 1]++;
+        }
+        std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+
+        Vec<Index> pos(m_offsets.begin(), m_offsets.end() - 1);
+        m_neighbors.resize(m_offsets.back());
+        m_conductances.resize(m_offsets.back());
+        m_slopes.assign(slopes ? m_offsets.back() : 0, 0);
+        for (const auto & edge : m_edges) {
+            auto g = 1 / edge.r;
+            auto p1 = pos[edge.n1]++, p2 = pos[edge.n2]++;
+            m_neighbors[p1] = edge.n2; m_conductances[p1] = g;
+            m_neighbors[p2] = edge.n1; m_conductances[p2] = g;
+            if (slopes) { m_slopes[p1] = edge.dg1; m_slopes[p2] = edge.dg2; }
+        }
+        Edges().swap(m_edges);
+    }
+
+    bool isFinalized() const { return m_offsets.size() == m_nodes.size() + 1; }
+
+    /// neighbors of node, sorted by node id
+    std::span<const Index> Neighbors(Index nid) const
+    {
+        return {m_neighbors.data() + m_offsets[nid], m_offsets[nid + 1] - m_offsets[nid]};
+    }
+
+    /// conductances of node to its neighbors, unit: W/K
+    std::span<const Scalar> Conductances(Index nid) const
+    {
+        return {m_conductances.data() + m_offsets[nid], m_offsets[nid + 1] - m_offsets[nid]};
+    }
+
+    /// derivatives of the conductances of node on its own temperature, unit: W/K^2, empty if no resistor has slopes
+    std::span<const Scalar> ConductanceSlopes(Index nid) const
+    {
+        if (m_slopes.empty()) return {};
+        return {m_slopes.data() + m_offsets[nid], m_offsets[nid + 1] - m_offsets[nid]};
     }
 
     void BuildIndexMap()
     {
-        m_nmMap.clear();
+        NS_ASSERT(isFinalized());
+        m_nmMap.assign(m_nodes.size(), INVALID_INDEX);
         m_mnMap.clear();
-        m_nmMap.reserve(m_nodes.size());
         m_mnMap.reserve(m_nodes.size());
-        Index nId{0}, mId{0};
-        for (auto & node : m_nodes) {
-            if (node.t != UNKNOWN_T) {
-                nId++; continue;
+        m_srcMap.assign(m_nodes.size(), INVALID_INDEX);
+        m_sources.clear();
+        for (size_t nId = 0; nId < m_nodes.size(); ++nId) {
+            if (m_nodes[nId].t != UNKNOWN_T) continue;
+            m_nmMap[nId] = m_mnMap.size();
+            m_mnMap.emplace_back(nId);
+            if (isSource(nId)) {
+                m_srcMap[nId] = m_sources.size();
+                m_sources.emplace_back(nId);
             }
-            m_nmMap.emplace(nId, mId);
-            m_mnMap.emplace(mId, nId);
-            mId++; nId++;
         }
+        HashTopology();
     }
 
-    Index NodeId(Index mId) const { return m_mnMap.at(mId); }
-    Index MatrixId(Index nId) const { return m_nmMap.at(nId); }
-
-    size_t NodeSize() const { return m_nodes.size(); }
-    size_t MatrixSize() const { return m_nmMap.size(); }
-    size_t SourceSize() const
+    /// permutes matrix ids after BuildIndexMap(), order[new matrix id] = old matrix id, sources follow the new matrix order
+    void Reorder(const Vec<Index> & order)
     {
-        size_t src = 0;
-        for (size_t i = 0; i < m_nodes.size(); ++i) {
-            if (isSource(i)) src++;
+        NS_ASSERT(order.size() == m_mnMap.size());
+        Vec<Index> mnMap(order.size());
+        for (size_t mid = 0; mid < order.size(); ++mid) {
+            mnMap[mid] = m_mnMap[order[mid]];
+            m_nmMap[mnMap[mid]] = mid;
+        }
+        m_mnMap = std::move(mnMap);
+        m_sources.clear();
+        for (auto nId : m_mnMap) {
+            if (INVALID_INDEX == m_srcMap[nId]) continue;
+            m_srcMap[nId] = m_sources.size();
+            m_sources.emplace_back(nId);
         }
-        return src;
+        HashTopology();
+    }
+
+    /// hash of connectivity, fixed temperature nodes and matrix order, equal topology gives equal matrix pattern
+    size_t Topology() const { return m_topology; }
+
+    Index NodeId(Index mId) const { return m_mnMap[mId]; }
+    Index MatrixId(Index nId) const { NS_ASSERT(m_nmMap[nId] != INVALID_INDEX); return m_nmMap[nId]; }
+    /// source column of node, INVALID_INDEX if node is not a source
+    Index SourceId(Index nId) const { return m_srcMap[nId]; }
+    /// source node ids in matrix order
+    const Vec<Index> & Sources() const { return m_sources; }
+
+    /// vertical node chain ordered top to bottom, hint of line relaxation
+    void AddColumn(const Vec<Index> & nodes)
+    {
+        if (m_columnStarts.empty()) m_columnStarts.emplace_back(0);
+        m_columnNodes.insert(m_columnNodes.end(), nodes.begin(), nodes.end());
+        m_columnStarts.emplace_back(m_columnNodes.size());
     }
 
+    std::span<const Index> Column(size_t i) const
+    {
+        return {m_columnNodes.data() + m_columnStarts[i], m_columnStarts[i + 1] - m_columnStarts[i]};
+    }
+
+    size_t NodeSize() const { return m_nodes.size(); }
+    size_t EdgeSize() const { return m_neighbors.size() / 2; }
+    size_t MatrixSize() const { return m_mnMap.size(); }
+    size_t SourceSize() const { return m_sources.size(); }
+    size_t ColumnSize() const { return m_columnStarts.empty() ? 0 : m_columnStarts.size() - 1; }
+
     std::string msg() const
     {
         std::stringstream ss;
@@ -109,9 +252,9 @@ public:
             auto & node = m_nodes[i];
             minC = std::min(minC, node.c);
             maxC = std::max(maxC, node.c);
-            for (auto & [n, r] : node.ns) {
-                minR = std::min(minR, r);
-                maxR = std::max(maxR, r);
+            for (auto g : Conductances(i)) {
+                minR = std::min<Scalar>(minR, 1 / g);
+                maxR = std::max<Scalar>(maxR, 1 / g);
             }
         }
         ss << "Min C: " << minC << ", Max C: " << maxC << std::endl;
@@ -119,35 +262,233 @@ public:
         return ss.str();
     }
 private:
+    /// keeps the cached sources of an indexed network, the list is rebuilt in matrix order only when the node changes its source state
+    void UpdateSource(Index nid)
+    {
+        if (m_srcMap.size() != m_nodes.size() || m_nodes[nid].t != UNKNOWN_T) return;
+        if (isSource(nid) == (INVALID_INDEX != m_srcMap[nid])) return;
+        m_srcMap[nid] = isSource(nid) ? 0 : INVALID_INDEX;
+        m_sources.clear();
+        for (auto nId : m_mnMap) {
+            if (INVALID_INDEX == m_srcMap[nId]) continue;
+            m_srcMap[nId] = m_sources.size();
+            m_sources.emplace_back(nId);
+        }
+    }
+
+    void HashTopology()
+    {
+        m_topology = boost::hash_range(m_neighbors.begin(), m_neighbors.end());
+        boost::hash_combine(m_topology, boost::hash_range(m_offsets.begin(), m_offsets.end()));
+        boost::hash_combine(m_topology, boost::hash_range(m_mnMap.begin(), m_mnMap.end()));
+        boost::hash_combine(m_topology, boost::hash_range(m_columnNodes.begin(), m_columnNodes.end()));
+    }
+
     Vec<Node> m_nodes;
-    HashMap<Index, Index> m_nmMap;
-    HashMap<Index, Index> m_mnMap;
+    Edges m_edges;
+    Vec<Index> m_offsets;
+    Vec<Index> m_neighbors;
+    Vec<Scalar> m_conductances;//unit: W/K
+    Vec<Scalar> m_slopes;//derivative of each conductance on the temperature of its row node, empty without slopes
+    size_t m_topology{0};
+    Vec<Index> m_nmMap;
+    Vec<Index> m_mnMap;
+    Vec<Index> m_srcMap;
+    Vec<Index> m_sources;
+    Vec<Index> m_columnStarts;
+    Vec<Index> m_columnNodes;
 };
 
 using namespace generic::ckt;
 
+template <typename Scalar>
+inline Scalar makeSourceRhs(const ThermalNetwork<Scalar> & network, Index nid, Scalar refT)
+{
+    const auto & node = network[nid];
+    Scalar rhs = node.hf + node.htc * refT;
+    auto ns = network.Neighbors(nid);
+    auto gs = network.Conductances(nid);
+    for (size_t k = 0; k < ns.size(); ++k) {
+        auto & nnode = network[ns[k]];
+        if (nnode.t != network.UNKNOWN_T)
+            rhs += nnode.t * gs[k];
+    }
+    return rhs;
+}
+
 template <typename Scalar>
 inline DenseVector<Scalar> makeRhs(const ThermalNetwork<Scalar> & network, Scalar refT)
 {
-    const auto ms = network.MatrixSize();
-    const auto ss = network.SourceSize();
-    DenseVector<Scalar> rhs(ss);
-    for (size_t mid = 0, s = 0; mid < ms; ++mid) {
+    const auto & sources = network.Sources();
+    DenseVector<Scalar> rhs(sources.size());
+    for (size_t s = 0; s < sources.size(); ++s)
+        rhs[s] = makeSourceRhs(network, sources[s], refT);
+    return rhs;
+}
+
+/// rhs in matrix order, equals to B * makeRhs(network, refT)
+template <typename Scalar>
+inline DenseVector<Scalar> makeMatrixRhs(const ThermalNetwork<Scalar> & network, Scalar refT)
+{
+    DenseVector<Scalar> rhs = DenseVector<Scalar>::Zero(network.MatrixSize());
+    for (auto nid : network.Sources())
+        rhs[network.MatrixId(nid)] = makeSourceRhs(network, nid, refT);
+    return rhs;
+}
+
+/// residual F(T) = G(T) T - q(T) in matrix order, T in node order, fixed temperature nodes use their own value
+template <typename Scalar>
+inline DenseVector<Scalar> makeResidual(const ThermalNetwork<Scalar> & network, Scalar refT, const Vec<Scalar> & T)
+{
+    NS_ASSERT(T.size() == network.NodeSize());
+    DenseVector<Scalar> F(network.MatrixSize());
+    auto temperature = [&](Index nid) { return network[nid].t != network.UNKNOWN_T ? network[nid].t : T[nid]; };
+    for (size_t mid = 0; mid < network.MatrixSize(); ++mid) {
         auto nid = network.NodeId(mid);
         const auto & node = network[nid];
-        if (network.isSource(nid)) {
-            rhs[s] = node.hf + node.htc * refT;
-            for (const auto & [nnid, r] : node.ns) {
-                auto & nnode = network[nnid];
-                if (nnode.t != network.UNKNOWN_T)
-                    rhs[s] += nnode.t / r;
-            }
-            s++;
+        Scalar f = node.htc * (T[nid] - refT) - node.hf;
+        auto ns = network.Neighbors(nid);
+        auto gs = network.Conductances(nid);
+        for (size_t k = 0; k < ns.size(); ++k)
+            f += gs[k] * (T[nid] - temperature(ns[k]));
+        F[mid] = f;
+    }
+    return F;
+}
+
+/// columns in matrix order, split at fixed temperature nodes, runs shorter than two nodes are dropped
+template <typename Scalar>
+inline void makeMatrixColumns(const ThermalNetwork<Scalar> & network, Vec<Index> & starts, Vec<Index> & ids)
+{
+    starts.assign(1, 0);
+    ids.clear();
+    auto close = [&] {
+        if (ids.size() - starts.back() > 1) starts.emplace_back(ids.size());
+        else ids.resize(starts.back());
+    };
+    for (size_t c = 0; c < network.ColumnSize(); ++c) {
+        for (auto nid : network.Column(c)) {
+            if (network[nid].t != network.UNKNOWN_T) close();
+            else ids.emplace_back(network.MatrixId(nid));
         }
+        close();
     }
-    return rhs;
 }
 
+/// symbolic structure of conductance matrix G, numeric values are refilled in place while topology is unchanged
+template <typename Scalar>
+class ConductancePattern
+{
+public:
+    /// topology hash first, sizes and row lengths guard against a hash collision reusing a wrong pattern
+    bool isValid(const ThermalNetwork<Scalar> & network) const
+    {
+        if (m_topology != network.Topology() || m_diag.size() != network.MatrixSize()) return false;
+        for (size_t mid = 0; mid < m_diag.size(); ++mid) {
+            if (m_starts[mid + 1] - m_starts[mid] != network.Neighbors(network.NodeId(mid)).size()) return false;
+        }
+        return true;
+    }
+
+    void Analyze(const ThermalNetwork<Scalar> & network, SparseMatrix<Scalar> & G)
+    {
+        using StorageIndex = typename SparseMatrix<Scalar>::StorageIndex;
+        const size_t ms = network.MatrixSize();
+        m_diag.resize(ms);
+        m_starts.assign(ms + 1, 0);
+        for (size_t mid = 0; mid < ms; ++mid)
+            m_starts[mid + 1] = m_starts[mid] + network.Neighbors(network.NodeId(mid)).size();
+        m_slots.assign(m_starts.back(), INVALID_INDEX);
+
+        size_t nnz{0};
+        Vec<Pair<Index, Index>> column;//[row, slot]
+        G = SparseMatrix<Scalar>(ms, ms);
+        G.resizeNonZeros(ms + m_starts.back());
+        auto outer = G.outerIndexPtr();
+        for (size_t mid = 0; mid < ms; ++mid) {
+            column.clear();
+            column.emplace_back(mid, INVALID_INDEX);
+            auto ns = network.Neighbors(network.NodeId(mid));
+            for (size_t k = 0; k < ns.size(); ++k) {
+                if (network[ns[k]].t == network.UNKNOWN_T)
+                    column.emplace_back(network.MatrixId(ns[k]), m_starts[mid] + k);
+            }
+            std::sort(column.begin(), column.end());
+            outer[mid] = nnz;
+            for (const auto & [row, slot] : column) {
+                if (INVALID_INDEX == slot) m_diag[mid] = nnz;
+                else m_slots[slot] = nnz;
+                G.innerIndexPtr()[nnz++] = StorageIndex(row);
+            }
+        }
+        outer[ms] = nnz;
+        G.resizeNonZeros(nnz);
+        m_topology = network.Topology();
+    }
+
+    void Fill(const ThermalNetwork<Scalar> & network, SparseMatrix<Scalar> & G) const
+    {
+        NS_ASSERT(isValid(network));
+        auto values = G.valuePtr();
+        std::fill(values, values + G.nonZeros(), Scalar(0));
+        for (size_t mid = 0; mid < m_diag.size(); ++mid) {
+            auto nid = network.NodeId(mid);
+            auto & diag = values[m_diag[mid]];
+            diag += network[nid].htc;
+            auto gs = network.Conductances(nid);
+            for (size_t k = 0; k < gs.size(); ++k) {
+                diag += gs[k];
+                if (auto slot = m_slots[m_starts[mid] + k]; INVALID_INDEX != slot)
+                    values[slot] -= gs[k];
+            }
+        }
+    }
+
+    /// G += diag(d), d in matrix order
+    void AddDiagonal(const DenseVector<Scalar> & d, SparseMatrix<Scalar> & G) const
+    {
+        NS_ASSERT(size_t(d.size()) == m_diag.size());
+        auto values = G.valuePtr();
+        for (size_t mid = 0; mid < m_diag.size(); ++mid)
+            values[m_diag[mid]] += d[mid];
+    }
+
+    /// J = dF/dT of makeResidual() at T (node order) from the slopes of the network, J has the pattern of G but is not symmetric,
+    /// column j holds dF/dT_j, so each column only needs the conductance slopes on the temperature of its own node:
+    /// J_jj = htc_j + sum_k (g_jk + dg_jk/dT_j (T_j - T_k)) - dhf_j/dT_j, J_kj = -g_jk + dg_jk/dT_j (T_k - T_j),
+    /// the derivative part of the diagonal is bounded below by (minDiagRatio - 1) times the picard diagonal,
+    /// so a power rising faster than the network removes heat cannot make J singular
+    void FillJacobian(const ThermalNetwork<Scalar> & network, const Vec<Scalar> & T, Scalar minDiagRatio, SparseMatrix<Scalar> & J) const
+    {
+        NS_ASSERT(isValid(network) && T.size() == network.NodeSize());
+        auto values = J.valuePtr();
+        std::fill(values, values + J.nonZeros(), Scalar(0));
+        auto temperature = [&](Index nid) { return network[nid].t != network.UNKNOWN_T ? network[nid].t : T[nid]; };
+        for (size_t mid = 0; mid < m_diag.size(); ++mid) {
+            auto nid = network.NodeId(mid);
+            auto ns = network.Neighbors(nid);
+            auto gs = network.Conductances(nid);
+            auto ds = network.ConductanceSlopes(nid);
+            Scalar diag = network[nid].htc, slope = -network[nid].slope;
+            for (size_t k = 0; k < gs.size(); ++k) {
+                auto dT = T[nid] - temperature(ns[k]);
+                auto dg = ds.empty() ? Scalar(0) : ds[k];
+                diag += gs[k];
+                slope += dg * dT;
+                if (auto slot = m_slots[m_starts[mid] + k]; INVALID_INDEX != slot)
+                    values[slot] = -gs[k] - dg * dT;
+            }
+            values[m_diag[mid]] = diag + std::max(slope, (minDiagRatio - 1) * diag);
+        }
+    }
+
+private:
+    size_t m_topology{0};
+    Vec<Index> m_diag;//value position of diagonal in G
+    Vec<Index> m_starts;//row offsets of slots in matrix order
+    Vec<Index> m_slots;//value position in G of each network neighbor, INVALID_INDEX for fixed temperature neighbor
+};
+
 template <typename Scalar>
 inline MNA<SparseMatrix<Scalar>> makeMNA(const ThermalNetwork<Scalar> & network, const Vec<Index> & probs = {})
 {
@@ -161,22 +502,27 @@ inline MNA<SparseMatrix<Scalar>> makeMNA(const ThermalNetwork<Scalar> & network,
     m.G = Matrix(ms, ms);
     m.C = Matrix(ms, ms);
     m.B = Matrix(ms, ss);
-    for (size_t mid = 0, s = 0; mid < ms; ++mid) {
+    for (size_t mid = 0; mid < ms; ++mid) {
         auto nid = network.NodeId(mid);
         const auto & node = network[nid];
-        for (const auto & [nnid, r] : node.ns) {
-            const auto & nnode = network[nnid];
+        auto ns = network.Neighbors(nid);
+        auto gs = network.Conductances(nid);
+        for (size_t k = 0; k < ns.size(); ++k) {
+            const auto & nnode = network[ns[k]];
             if (nnode.t != network.UNKNOWN_T)
-                mna::Stamp(tG, mid, 1 / r);
-            else {
-                auto nmid = network.MatrixId(nnid);
-                mna::Stamp(tG, mid, nmid, 1 / r);
+                mna::Stamp(tG, mid, gs[k]);
+            else if (nid < ns[k]) {
+                auto nmid = network.MatrixId(ns[k]);
+                mna::Stamp(tG, mid, nmid, gs[k]);
             }
         }
         if (node.htc != 0) mna::Stamp(tG, mid, node.htc);
         if (node.c > 0) mna::Stamp(tC, mid, node.c);
-        if (network.isSource(nid)) tB.emplace_back(mid, s++, 1);
     }
+    const auto & sources = network.Sources();
+    tB.reserve(sources.size());
+    for (size_t s = 0; s < sources.size(); ++s)
+        tB.emplace_back(network.MatrixId(sources[s]), s, 1);
     m.G.setFromTriplets(tG.begin(), tG.end());
     m.C.setFromTriplets(tC.begin(), tC.end());
     m.B.setFromTriplets(tB.begin(), tB.end());
@@ -189,7 +535,7 @@ inline MNA<SparseMatrix<Scalar>> makeMNA(const ThermalNetwork<Scalar> & network,
         size_t j{0};
         Triplets tL;
         for (auto p : probs) {
-            NS_ASSERT(network[p].t != network.UNKNOWN_T);
+            NS_ASSERT(network[p].t == network.UNKNOWN_T);
             auto mid = network.MatrixId(p);
             tL.emplace_back(mid, j++, 1);
         }
@@ -0,0 +1,386 @@
+#pragma once
+#include "basic/NSHeatAlias.hpp"
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/Sparse>
+#include <numeric>
+namespace nano::heat::solver::network {
+
+namespace amg {
+
+template <typename Scalar>
+using RowMatrix = Eigen::SparseMatrix<Scalar, Eigen::RowMajor, int>;
+
+template <typename Scalar>
+using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+/// y = A x, rows in parallel
+template <typename Scalar>
+inline void SpMV(const RowMatrix<Scalar> & A, const Vector<Scalar> & x, Vector<Scalar> & y)
+{
+    const Eigen::Index n = A.rows();
+    y.resize(n);
+    auto outer = A.outerIndexPtr();
+    auto inner = A.innerIndexPtr();
+    auto values = A.valuePtr();
+    #pragma omp parallel for schedule(static)
+    for (Eigen::Index i = 0; i < n; ++i) {
+        Scalar s = 0;
+        for (auto p = outer[i]; p < outer[i + 1]; ++p)
+            s += values[p] * x[inner[p]];
+        y[i] = s;
+    }
+}
+
+/// r = b - A x, rows in parallel
+template <typename Scalar>
+inline void Residual(const RowMatrix<Scalar> & A, const Vector<Scalar> & b, const Vector<Scalar> & x, Vector<Scalar> & r)
+{
+    const Eigen::Index n = A.rows();
+    r.resize(n);
+    auto outer = A.outerIndexPtr();
+    auto inner = A.innerIndexPtr();
+    auto values = A.valuePtr();
+    #pragma omp parallel for schedule(static)
+    for (Eigen::Index i = 0; i < n; ++i) {
+        Scalar s = b[i];
+        for (auto p = outer[i]; p < outer[i + 1]; ++p)
+            s -= values[p] * x[inner[p]];
+        r[i] = s;
+    }
+}
+
+/// C = A * B, rows in parallel with a dense accumulator per thread, column indices of each row are sorted
+template <typename Scalar>
+inline RowMatrix<Scalar> SpGEMM(const RowMatrix<Scalar> & A, const RowMatrix<Scalar> & B)
+{
+    NS_ASSERT(A.cols() == B.rows());
+    const Eigen::Index rows = A.rows(), cols = B.cols();
+    auto aOuter = A.outerIndexPtr(); auto aInner = A.innerIndexPtr(); auto aValues = A.valuePtr();
+    auto bOuter = B.outerIndexPtr(); auto bInner = B.innerIndexPtr(); auto bValues = B.valuePtr();
+
+    Vec<int> counts(rows + 1, 0);
+    #pragma omp parallel
+    {
+        Vec<Eigen::Index> marker(cols, -1);
+        #pragma omp for schedule(dynamic, 1024)
+        for (Eigen::Index i = 0; i < rows; ++i) {
+            int count{0};
+            for (auto p = aOuter[i]; p < aOuter[i + 1]; ++p) {
+                auto k = aInner[p];
+                for (auto q = bOuter[k]; q < bOuter[k + 1]; ++q) {
+                    if (marker[bInner[q]] == i) continue;
+                    marker[bInner[q]] = i;
+                    count++;
+                }
+            }
+            counts[i + 1] = count;
+        }
+    }
+    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+
+    RowMatrix<Scalar> C(rows, cols);
+    C.resizeNonZeros(counts.back());
+    std::copy(counts.begin(), counts.end(), C.outerIndexPtr());
+    auto cInner = C.innerIndexPtr(); auto cValues = C.valuePtr();
+    #pragma omp parallel
+    {
+        Vec<Eigen::Index> marker(cols, -1);
+        Vec<Scalar> accum(cols, 0);
+        #pragma omp for schedule(dynamic, 1024)
+        for (Eigen::Index i = 0; i < rows; ++i) {
+            auto begin = counts[i], end = begin;
+            for (auto p = aOuter[i]; p < aOuter[i + 1]; ++p) {
+                auto k = aInner[p];
+                for (auto q = bOuter[k]; q < bOuter[k + 1]; ++q) {
+                    auto j = bInner[q];
+                    if (marker[j] != i) {
+                        marker[j] = i;
+                        accum[j] = 0;
+                        cInner[end++] = j;
+                    }
+                    accum[j] += aValues[p] * bValues[q];
+                }
+            }
+            std::sort(cInner + begin, cInner + end);
+            for (auto p = begin; p < end; ++p)
+                cValues[p] = accum[cInner[p]];
+        }
+    }
+    return C;
+}
+
+} // namespace amg
+
+/// smoothed aggregation algebraic multigrid, used as a V-cycle preconditioner of CG, every setup phase runs in parallel
+/// aggregates are computed by the first factorize() after analyzePattern() and reused while the pattern is unchanged,
+/// later factorize() only rebuild the smoothed prolongators and galerkin products
+template <typename Scalar>
+class SmoothedAggregationAMG
+{
+    using RowMatrix = amg::RowMatrix<Scalar>;
+    using Vector = amg::Vector<Scalar>;
+public:
+    using StorageIndex = typename Vector::StorageIndex;
+    enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic };
+    enum class Smoother { JACOBI, CHEBYSHEV };
+
+    SmoothedAggregationAMG() = default;
+
+    template <typename MatType>
+    explicit SmoothedAggregationAMG(const MatType & mat) { compute(mat); }
+
+    void setSmoother(Smoother smoother) { m_smoother = smoother; }
+    void setSmoothSteps(size_t steps) { m_steps = std::max<size_t>(1, steps); }
+    void setCoarseSize(size_t size) { m_coarseSize = std::max<size_t>(1, size); }
+    void setStrength(Scalar theta) { m_theta = theta; }
+
+    Eigen::Index rows() const { return m_size; }
+    Eigen::Index cols() const { return m_size; }
+    size_t levels() const { return m_levels.size() + 1; }
+
+    template <typename MatType>
+    SmoothedAggregationAMG & analyzePattern(const MatType & mat)
+    {
+        m_size = mat.rows();
+        m_aggregates.clear();
+        return *this;
+    }
+
+    template <typename MatType>
+    SmoothedAggregationAMG & factorize(const MatType & mat)
+    {
+        m_size = mat.rows();
+        RowMatrix A = mat;
+        bool reuse = not m_aggregates.empty();
+        m_levels.clear();
+        for (size_t l = 0; size_t(A.rows()) > m_coarseSize && l < MAX_LEVELS; ++l) {
+            Level level;
+            level.dinv = A.diagonal().cwiseInverse();
+            level.lambda = EstimateSpectralRadius(A, level.dinv);
+            if (not reuse) {
+                auto & aggregates = m_aggregates.emplace_back();
+                auto coarse = Aggregate(A, aggregates);
+                if (coarse == 0 || coarse * 10 > size_t(A.rows()) * 9) {//coarsening stalled
+                    m_aggregates.pop_back();
+                    break;
+                }
+            }
+            else if (l == m_aggregates.size()) break;
+
+            const auto & aggregates = m_aggregates.at(l);
+            auto coarse = *std::max_element(aggregates.cbegin(), aggregates.cend()) + 1;
+            RowMatrix T(A.rows(), coarse);
+            T.resizeNonZeros(A.rows());
+            for (Eigen::Index i = 0; i < A.rows(); ++i) {
+                T.outerIndexPtr()[i] = i;
+                T.innerIndexPtr()[i] = aggregates[i];
+                T.valuePtr()[i] = 1;
+            }
+            T.outerIndexPtr()[A.rows()] = A.rows();
+
+            //P = (I - w D^-1 A) T, w = 4 / (3 lambda)
+            Scalar omega = Scalar(4) / (3 * level.lambda);
+            RowMatrix AT = amg::SpGEMM(A, T);
+            level.P = T - (omega * level.dinv).asDiagonal() * AT;
+            level.R = level.P.transpose();
+            RowMatrix AP = amg::SpGEMM(A, level.P);
+            RowMatrix Ac = amg::SpGEMM(level.R, AP);
+            level.A = std::move(A);
+            A = std::move(Ac);
+            m_levels.emplace_back(std::move(level));
+        }
+        m_coarse.compute(Eigen::SparseMatrix<Scalar>(A));
+        m_info = m_coarse.info();
+
+        m_b.resize(m_levels.size() + 1);
+        m_x.resize(m_levels.size() + 1);
+        m_r.resize(m_levels.size());
+        m_d.resize(m_levels.size());
+        return *this;
+    }
+
+    template <typename MatType>
+    SmoothedAggregationAMG & compute(const MatType & mat)
+    {
+        analyzePattern(mat);
+        return factorize(mat);
+    }
+
+    template <typename Rhs, typename Dest>
+    void _solve_impl(const Rhs & b, Dest & x) const
+    {
+        m_b.front() = b;
+        VCycle(0);
+        x = m_x.front();
+    }
+
+    template <typename Rhs>
+    inline const Eigen::Solve<SmoothedAggregationAMG, Rhs> solve(const Eigen::MatrixBase<Rhs> & b) const
+    {
+        return Eigen::Solve<SmoothedAggregationAMG, Rhs>(*this, b.derived());
+    }
+
+    Eigen::ComputationInfo info() const { return m_info; }
+
+private:
+    struct Level
+    {
+        RowMatrix A, P, R;
+        Vector dinv;
+        Scalar lambda = 1;//spectral radius of D^-1 A
+    };
+
+    /// standard three phase aggregation on strong connections |a_ij| >= theta * sqrt(a_ii * a_jj),
+    /// fixed blocks of AGGREGATE_BLOCK rows are aggregated in parallel and strong connections leaving a block are ignored,
+    /// so the aggregates do not depend on the thread count and a matrix of one block is aggregated as a serial sweep
+    size_t Aggregate(const RowMatrix & A, Vec<int> & aggregates) const
+    {
+        const Eigen::Index n = A.rows();
+        auto outer = A.outerIndexPtr();
+        auto inner = A.innerIndexPtr();
+        auto values = A.valuePtr();
+        Vector diag = A.diagonal().cwiseAbs();
+        const Eigen::Index blocks = (n + AGGREGATE_BLOCK - 1) / AGGREGATE_BLOCK;
+        Vec<int> offsets(blocks + 1, 0);
+        aggregates.assign(n, -1);
+        #pragma omp parallel for schedule(dynamic)
+        for (Eigen::Index b = 0; b < blocks; ++b) {
+            const Eigen::Index begin = b * AGGREGATE_BLOCK, end = std::min<Eigen::Index>(n, begin + AGGREGATE_BLOCK);
+            auto isStrong = [&](Eigen::Index i, int p) {
+                auto j = inner[p];
+                return j != i && j >= begin && j < end && std::abs(values[p]) >= m_theta * std::sqrt(diag[i] * diag[j]);
+            };
+            int coarse{0};
+            //phase 1: root nodes with all strong neighbors free
+            for (Eigen::Index i = begin; i < end; ++i) {
+                if (aggregates[i] != -1) continue;
+                bool free{true}, any{false};
+                for (auto p = outer[i]; p < outer[i + 1] && free; ++p) {
+                    if (not isStrong(i, p)) continue;
+                    any = true;
+                    free = aggregates[inner[p]] == -1;
+                }
+                if (not free || not any) continue;
+                aggregates[i] = coarse;
+                for (auto p = outer[i]; p < outer[i + 1]; ++p)
+                    if (isStrong(i, p)) aggregates[inner[p]] = coarse;
+                coarse++;
+            }
+            //phase 2: attach to the strongest neighboring aggregate of phase 1
+            Vec<int> phase1(aggregates.begin() + begin, aggregates.begin() + end);
+            for (Eigen::Index i = begin; i < end; ++i) {
+                if (phase1[i - begin] != -1) continue;
+                Scalar strongest = 0;
+                for (auto p = outer[i]; p < outer[i + 1]; ++p) {
+                    if (not isStrong(i, p) || phase1[inner[p] - begin] == -1) continue;
+                    if (std::abs(values[p]) > strongest) {
+                        strongest = std::abs(values[p]);
+                        aggregates[i] = phase1[inner[p] - begin];
+                    }
+                }
+            }
+            //phase 3: remaining nodes with their free strong neighbors
+            for (Eigen::Index i = begin; i < end; ++i) {
+                if (aggregates[i] != -1) continue;
+                aggregates[i] = coarse;
+                for (auto p = outer[i]; p < outer[i + 1]; ++p)
+                    if (isStrong(i, p) && aggregates[inner[p]] == -1) aggregates[inner[p]] = coarse;
+                coarse++;
+            }
+            offsets[b + 1] = coarse;
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        #pragma omp parallel for schedule(static)
+        for (Eigen::Index b = 1; b < blocks; ++b) {
+            const Eigen::Index begin = b * AGGREGATE_BLOCK, end = std::min<Eigen::Index>(n, begin + AGGREGATE_BLOCK);
+            for (Eigen::Index i = begin; i < end; ++i) aggregates[i] += offsets[b];
+        }
+        return offsets.back();
+    }
+
+    /// power iteration on D^-1 A with a deterministic start vector
+    Scalar EstimateSpectralRadius(const RowMatrix & A, const Vector & dinv) const
+    {
+        const Eigen::Index n = A.rows();
+        Vector x(n), y(n);
+        for (Eigen::Index i = 0; i < n; ++i)
+            x[i] = Scalar(1) + Scalar(i % 7) / 7;
+        x.normalize();
+        Scalar lambda = 1;
+        for (size_t k = 0; k < POWER_ITERATIONS; ++k) {
+            amg::SpMV(A, x, y);
+            y = y.cwiseProduct(dinv);
+            lambda = y.norm();
+            if (not (lambda > 0)) return 1;
+            x = y / lambda;
+        }
+        return SAFETY * lambda;
+    }
+
+    void Smooth(size_t l, bool zeroGuess) const
+    {
+        const auto & level = m_levels[l];
+        const auto & b = m_b[l];
+        auto & x = m_x[l];
+        auto & r = m_r[l];
+        if (zeroGuess) x.setZero(b.size());
+        if (Smoother::JACOBI == m_smoother) {
+            Scalar omega = Scalar(4) / (3 * level.lambda);
+            for (size_t k = 0; k < m_steps; ++k) {
+                amg::Residual(level.A, b, x, r);
+                x += omega * level.dinv.cwiseProduct(r);
+            }
+            return;
+        }
+        //chebyshev polynomial of D^-1 A on [lambda / 30, lambda]
+        auto & d = m_d[l];
+        Scalar upper = level.lambda, lower = upper / 30;
+        Scalar theta = (upper + lower) / 2, delta = (upper - lower) / 2;
+        Scalar sigma = theta / delta, rho = 1 / sigma;
+        amg::Residual(level.A, b, x, r);
+        d = level.dinv.cwiseProduct(r) / theta;
+        for (size_t k = 0; k < m_steps; ++k) {
+            x += d;
+            if (k + 1 == m_steps) break;
+            amg::Residual(level.A, b, x, r);
+            Scalar rhoNew = 1 / (2 * sigma - rho);
+            d = rhoNew * rho * d + 2 * rhoNew / delta * level.dinv.cwiseProduct(r);
+            rho = rhoNew;
+        }
+    }
+
+    void VCycle(size_t l) const
+    {
+        if (l == m_levels.size()) {
+            m_x[l] = m_coarse.solve(m_b[l]);
+            return;
+        }
+        const auto & level = m_levels[l];
+        Smooth(l, true);
+        amg::Residual(level.A, m_b[l], m_x[l], m_r[l]);
+        amg::SpMV(level.R, m_r[l], m_b[l + 1]);
+        VCycle(l + 1);
+        amg::SpMV(level.P, m_x[l + 1], m_r[l]);
+        m_x[l] += m_r[l];
+        Smooth(l, false);
+    }
+
+private:
+    inline static constexpr size_t MAX_LEVELS = 20;
+    inline static constexpr Eigen::Index AGGREGATE_BLOCK = 4096;//rows aggregated by one task
+    inline static constexpr size_t POWER_ITERATIONS = 10;
+    inline static constexpr Scalar SAFETY = 1.1;
+    Smoother m_smoother{Smoother::JACOBI};
+    size_t m_steps{2};
+    size_t m_coarseSize{500};
+    Scalar m_theta{0.08};
+    Eigen::Index m_size{0};
+    Vec<Level> m_levels;
+    Vec<Vec<int>> m_aggregates;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<Scalar>> m_coarse;
+    Eigen::ComputationInfo m_info{Eigen::Success};
+    mutable Vec<Vector> m_b, m_x, m_r, m_d;
+};
+
+} // namespace nano::heat::solver::network
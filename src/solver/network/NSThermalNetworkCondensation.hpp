@@ -0,0 +1,194 @@
+#pragma once
+#include "NSThermalNetwork.hpp"
+
+namespace nano::heat::solver::network {
+
+/// static condensation of series node chains, e.g. the segments of bonding wires,
+/// an interior node has exactly two neighbors, unknown temperature and no convection, so it carries no state in static solves,
+/// every chain between its end nodes a and b collapses to the series conductance of its segments,
+/// the heat of each interior node is split to a and b by the inverse ratio of the resistances to them,
+/// interior temperatures are recovered exactly by back substitution from the end temperatures
+template <typename Scalar>
+class ChainCondensation
+{
+public:
+    using Network = ThermalNetwork<Scalar>;
+
+    bool isValid(CRef<Network> network) const
+    {
+        return m_topology == network.Topology() && m_reduced.size() == network.NodeSize();
+    }
+
+    size_t ChainSize() const { return m_ends.size(); }
+    size_t InteriorSize() const { return m_nodes.size(); }
+    /// node id in the condensed network of each node, INVALID_INDEX for chain interior nodes
+    Index ReducedId(Index nid) const { return m_reduced[nid]; }
+
+    /// finds the chains on topology change, closed loops of interior nodes are kept
+    void Analyze(CRef<Network> network)
+    {
+        const size_t size = network.NodeSize();
+        auto isInterior = [&](Index n) {
+            const auto & node = network[n];
+            return node.t == network.UNKNOWN_T && 0 == node.htc && 2 == network.Neighbors(n).size();
+        };
+        auto next = [&](Index n, Index prev) {
+            auto ns = network.Neighbors(n);
+            return ns[0] == prev ? ns[1] : ns[0];
+        };
+        m_ends.clear();
+        m_nodes.clear();
+        m_sides.clear();
+        m_starts.assign(1, 0);
+        Vec<bool> visit(size, false);
+        for (size_t n = 0; n < size; ++n) {
+            if (visit[n] || not isInterior(n)) continue;
+            //walk back to end a
+            Index prev = n, a = network.Neighbors(n)[0];
+            while (isInterior(a) && Index(n) != a) {
+                auto tmp = next(a, prev);
+                prev = a; a = tmp;
+            }
+            if (Index(n) == a) {
+                //closed loop, no end node
+                for (Index m = n; not visit[m]; ) {
+                    visit[m] = true;
+                    auto tmp = next(m, prev);
+                    prev = m; m = tmp;
+                }
+                continue;
+            }
+            //walk forward from a to end b, side is the neighbor position toward a
+            Index b = prev;
+            for (prev = a; isInterior(b); ) {
+                visit[b] = true;
+                m_nodes.emplace_back(b);
+                m_sides.emplace_back(network.Neighbors(b)[0] == prev ? 0 : 1);
+                auto tmp = next(b, prev);
+                prev = b; b = tmp;
+            }
+            m_ends.emplace_back(a, b);
+            m_starts.emplace_back(m_nodes.size());
+        }
+
+        m_reduced.assign(size, 0);
+        for (auto n : m_nodes) m_reduced[n] = INVALID_INDEX;
+        m_keep.clear();
+        for (size_t n = 0; n < size; ++n) {
+            if (INVALID_INDEX == m_reduced[n]) continue;
+            m_reduced[n] = m_keep.size();
+            m_keep.emplace_back(n);
+        }
+        m_topology = network.Topology();
+        NS_TRACE("chain condensation, chains: %1%, eliminated nodes: %2%", ChainSize(), InteriorSize());
+    }
+
+    /// network without chain interior nodes, node ids follow ReducedId(), matrix order follows the order of network
+    UPtr<Network> Condense(CRef<Network> network) const
+    {
+        NS_ASSERT(isValid(network));
+        auto reduced = std::make_unique<Network>(m_keep.size());
+        for (size_t i = 0; i < m_keep.size(); ++i) {
+            auto nid = m_keep[i];
+            (*reduced)[i] = network[nid];
+            auto ns = network.Neighbors(nid);
+            auto gs = network.Conductances(nid);
+            for (size_t k = 0; k < ns.size(); ++k) {
+                if (auto j = m_reduced[ns[k]]; INVALID_INDEX != j && Index(i) < j)
+                    reduced->SetR(i, j, 1 / gs[k]);
+            }
+        }
+        Vec<Scalar> rl;
+        for (size_t c = 0; c < ChainSize(); ++c) {
+            auto r = Resistances(network, c, rl);
+            auto [a, b] = m_ends[c];
+            auto ra = m_reduced[a], rb = m_reduced[b];
+            for (size_t j = 0; j < rl.size(); ++j) {
+                auto q = network[m_nodes[m_starts[c] + j]].hf;
+                reduced->AddHF(ra, q * (r - rl[j]) / r);
+                reduced->AddHF(rb, q * rl[j] / r);
+            }
+            if (a != b) reduced->SetR(ra, rb, r);
+        }
+        Vec<Index> column;
+        for (size_t c = 0; c < network.ColumnSize(); ++c) {
+            column.clear();
+            for (auto nid : network.Column(c)) {
+                if (auto i = m_reduced[nid]; INVALID_INDEX != i) column.emplace_back(i);
+            }
+            if (column.size() > 1) reduced->AddColumn(column);
+        }
+        reduced->Finalize();
+        reduced->BuildIndexMap();
+        Vec<Index> order;
+        order.reserve(reduced->MatrixSize());
+        for (size_t mid = 0; mid < network.MatrixSize(); ++mid) {
+            if (auto i = m_reduced[network.NodeId(mid)]; INVALID_INDEX != i)
+                order.emplace_back(reduced->MatrixId(i));
+        }
+        reduced->Reorder(order);
+        return reduced;
+    }
+
+    /// values of the condensed network nodes, e.g. an initial guess, T in node order of network
+    Vec<Scalar> Restrict(const Vec<Scalar> & T) const
+    {
+        NS_ASSERT(T.size() == m_reduced.size());
+        Vec<Scalar> result(m_keep.size());
+        for (size_t i = 0; i < m_keep.size(); ++i)
+            result[i] = T[m_keep[i]];
+        return result;
+    }
+
+    /// back substitution, T of the condensed network to T of network, the flow into a chain from a is
+    /// F0 = (Ta - Tb - sum q_j (R - Rl_j)) / R and each interior node drops its segment resistance times the flow through it
+    void Expand(CRef<Network> network, const Vec<Scalar> & reducedT, Vec<Scalar> & T) const
+    {
+        NS_ASSERT(isValid(network) && reducedT.size() == m_keep.size());
+        T.resize(network.NodeSize());
+        for (size_t i = 0; i < m_keep.size(); ++i)
+            T[m_keep[i]] = reducedT[i];
+        Vec<Scalar> rl;
+        for (size_t c = 0; c < ChainSize(); ++c) {
+            auto r = Resistances(network, c, rl);
+            auto [a, b] = m_ends[c];
+            Scalar flow = T[a] - T[b];
+            for (size_t j = 0; j < rl.size(); ++j)
+                flow -= network[m_nodes[m_starts[c] + j]].hf * (r - rl[j]);
+            flow /= r;
+            Scalar t = T[a], prev = 0;
+            for (size_t j = 0; j < rl.size(); ++j) {
+                auto nid = m_nodes[m_starts[c] + j];
+                t -= flow * (rl[j] - prev);
+                T[nid] = t;
+                flow += network[nid].hf;
+                prev = rl[j];
+            }
+        }
+    }
+
+private:
+    /// rl: resistance from end a to each interior node of chain c, returns the total resistance a to b, unit: K/W
+    Scalar Resistances(CRef<Network> network, size_t c, Vec<Scalar> & rl) const
+    {
+        rl.resize(m_starts[c + 1] - m_starts[c]);
+        Scalar r = 0;
+        for (size_t j = 0; j < rl.size(); ++j) {
+            auto k = m_starts[c] + j;
+            r += 1 / network.Conductances(m_nodes[k])[m_sides[k]];
+            rl[j] = r;
+        }
+        auto last = m_starts[c + 1] - 1;
+        return r + 1 / network.Conductances(m_nodes[last])[1 - m_sides[last]];
+    }
+
+    size_t m_topology{0};
+    Vec<Pair<Index, Index>> m_ends;//end nodes a, b of each chain
+    Vec<Index> m_starts;//offset of each chain in m_nodes
+    Vec<Index> m_nodes;//interior nodes of each chain from a to b
+    Vec<uint8_t> m_sides;//neighbor position of each interior node toward a
+    Vec<Index> m_reduced;
+    Vec<Index> m_keep;//node id in network of each condensed network node
+};
+
+} // namespace nano::heat::solver::network
@@ -0,0 +1,793 @@
+#pragma once
+#include "basic/NSHeatCommon.hpp"
+#include "NSThermalNetworkPreconditioner.hpp"
+#include "NSThermalNetworkAMG.hpp"
+#include "NSThermalNetworkPartition.hpp"
+#include "NSThermalNetworkSELL.hpp"
+#include "generic/math/MathUtility.hpp"
+
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseLU>
+#include <Eigen/OrderingMethods>
+#include <Eigen/Sparse>
+namespace nano::heat::solver::network {
+
+using namespace generic::math::la;
+
+struct LinearSolveSummary
+{
+    size_t iterations = 0;
+    double residual = 0;//relative residual, |b - Gx| / |b|
+    bool converged = false;
+};
+
+/// solver of G x = b, the symbolic phase runs once per matrix pattern and the numeric phase once per value change
+template <typename Scalar>
+class LinearSolver
+{
+public:
+    using Matrix = SparseMatrix<Scalar>;
+    using Vector = DenseVector<Scalar>;
+    using Block = DenseMatrix<Scalar>;
+    LinearSolveSummary summary;
+    virtual ~LinearSolver() = default;
+
+    /// relative residual tolerance of iterative solvers, ignored by direct solvers
+    virtual void SetTolerance(Scalar tolerance) { NS_UNUSED(tolerance); }
+    /// strongly coupled node lines in matrix order, used by line relaxation, set before Analyze()
+    virtual void SetLines(Vec<Index> starts, Vec<Index> ids) { NS_UNUSED(starts); NS_UNUSED(ids); }
+    virtual void Analyze(const Matrix & G) = 0;
+    /// G may be referenced by Solve() (LDLT and mixed precision keep a pointer to compute the residual in Scalar),
+    /// so it must stay alive and unchanged until the next Factorize() or the destruction of the solver
+    virtual void Factorize(const Matrix & G) = 0;
+    /// x is used as initial guess if guess is true
+    virtual bool Solve(const Vector & b, Vector & x, bool guess) = 0;
+
+    /// G X = B for all columns against one factorization, iterations are summed and the residual is the worst column
+    virtual bool Solve(const Block & B, Block & X)
+    {
+        LinearSolveSummary total{0, 0, true};
+        X.resize(B.rows(), B.cols());
+        Vector b, x;
+        for (Eigen::Index c = 0; c < B.cols(); ++c) {
+            b = B.col(c);
+            Solve(b, x, false);
+            X.col(c) = x;
+            total.iterations += summary.iterations;
+            total.residual = std::max(total.residual, summary.residual);
+            total.converged = total.converged && summary.converged;
+        }
+        summary = total;
+        return summary.converged;
+    }
+};
+
+/// pcg with the given preconditioner, a preconditioner that fails to factorize (e.g. ic or line breakdown on a matrix
+/// which is not diagonally dominant, singular amg coarse level) is replaced by jacobi until the next Factorize()
+template <typename Scalar, typename Preconditioner>
+class ConjugateGradientSolver : public LinearSolver<Scalar>
+{
+public:
+    using Matrix = typename LinearSolver<Scalar>::Matrix;
+    using Vector = typename LinearSolver<Scalar>::Vector;
+    using LinearSolver<Scalar>::Solve;
+    explicit ConjugateGradientSolver(CRef<ThermalNetworkLinearSolverSettings> settings)
+    {
+        if (settings.tolerance > 0) SetTolerance(settings.tolerance);
+        if (settings.maxIter > 0) {
+            m_cg.setMaxIterations(settings.maxIter);
+            m_jacobi.setMaxIterations(settings.maxIter);
+        }
+    }
+
+    Preconditioner & GetPreconditioner() { return m_cg.preconditioner(); }
+
+    void SetTolerance(Scalar tolerance) override
+    {
+        m_cg.setTolerance(tolerance);
+        m_jacobi.setTolerance(tolerance);
+    }
+    void SetLines(Vec<Index> starts, Vec<Index> ids) override
+    {
+        if constexpr (requires (Preconditioner & p) { p.setLines(std::move(starts), std::move(ids)); })
+            m_cg.preconditioner().setLines(std::move(starts), std::move(ids));
+    }
+    void Analyze(const Matrix & G) override { m_cg.analyzePattern(G); }
+    void Factorize(const Matrix & G) override
+    {
+        m_cg.factorize(G);
+        m_fallback = m_cg.preconditioner().info() != Eigen::Success;
+        if (m_fallback) {
+            NS_TRACE("preconditioner factorization failed, fall back to jacobi");
+            m_jacobi.compute(G);
+        }
+    }
+
+    bool Solve(const Vector & b, Vector & x, bool guess) override
+    {
+        auto solve = [&](auto & cg) {
+            if (guess) x = cg.solveWithGuess(b, x);
+            else x = cg.solve(b);
+            this->summary.iterations = cg.iterations();
+            this->summary.residual = cg.error();
+            this->summary.converged = cg.info() == Eigen::Success;
+        };
+        if (m_fallback) solve(m_jacobi);
+        else solve(m_cg);
+        return this->summary.converged;
+    }
+
+private:
+    bool m_fallback{false};
+    Eigen::ConjugateGradient<Matrix, Eigen::Lower | Eigen::Upper, Preconditioner> m_cg;
+    Eigen::ConjugateGradient<Matrix, Eigen::Lower | Eigen::Upper, Eigen::DiagonalPreconditioner<Scalar>> m_jacobi;
+};
+
+/// sparse LDL^T with AMD fill reducing ordering, ordering and elimination tree are computed once per pattern,
+/// the residual is computed against the G of the last Factorize(), which is referenced and not copied
+template <typename Scalar>
+class CholeskySolver : public LinearSolver<Scalar>
+{
+public:
+    using Matrix = typename LinearSolver<Scalar>::Matrix;
+    using Vector = typename LinearSolver<Scalar>::Vector;
+    using Block = typename LinearSolver<Scalar>::Block;
+    using LinearSolver<Scalar>::Solve;
+
+    void Analyze(const Matrix & G) override { m_ldlt.analyzePattern(G); }
+    void Factorize(const Matrix & G) override
+    {
+        m_G = &G;
+        m_ldlt.factorize(G);
+        if (m_ldlt.info() != Eigen::Success) NS_TRACE("ldlt factorization failed, matrix is singular");
+    }
+
+    /// fails with x = 0 if the factorization failed
+    bool Solve(const Vector & b, Vector & x, bool guess) override
+    {
+        NS_UNUSED(guess);
+        NS_ASSERT(m_G && m_G->rows() == b.size());
+        if (m_ldlt.info() != Eigen::Success) {
+            x.setZero(b.size());
+            this->summary = LinearSolveSummary{0, b.norm() > 0 ? 1.0 : 0.0, false};
+            return false;
+        }
+        x = m_ldlt.solve(b);
+        auto bNorm = b.norm();
+        this->summary.iterations = 1;
+        this->summary.residual = bNorm > 0 ? (b - *m_G * x).norm() / bNorm : 0;
+        this->summary.converged = m_ldlt.info() == Eigen::Success;
+        return this->summary.converged;
+    }
+
+    /// blocked forward and backward substitution of all columns at once
+    bool Solve(const Block & B, Block & X) override
+    {
+        NS_ASSERT(m_G && m_G->rows() == B.rows());
+        if (m_ldlt.info() != Eigen::Success) {
+            X.setZero(B.rows(), B.cols());
+            this->summary = LinearSolveSummary{0, B.cols() > 0 && B.norm() > 0 ? 1.0 : 0.0, false};
+            return false;
+        }
+        X = m_ldlt.solve(B);
+        this->summary.iterations = 1;
+        this->summary.residual = 0;
+        Block R = B - *m_G * X;
+        for (Eigen::Index c = 0; c < B.cols(); ++c) {
+            if (auto bNorm = B.col(c).norm(); bNorm > 0)
+                this->summary.residual = std::max<double>(this->summary.residual, R.col(c).norm() / bNorm);
+        }
+        this->summary.converged = m_ldlt.info() == Eigen::Success;
+        return this->summary.converged;
+    }
+
+private:
+    CPtr<Matrix> m_G{nullptr};//G of the last Factorize(), owned by the caller
+    Eigen::SimplicialLDLT<Matrix, Eigen::Lower, Eigen::AMDOrdering<typename Matrix::StorageIndex>> m_ldlt;
+};
+
+/// sparse LU of a nonsymmetric matrix with the pattern of G, e.g. the newton jacobian, COLAMD column ordering
+template <typename Scalar>
+class SparseLUSolver : public LinearSolver<Scalar>
+{
+public:
+    using Matrix = typename LinearSolver<Scalar>::Matrix;
+    using Vector = typename LinearSolver<Scalar>::Vector;
+    using LinearSolver<Scalar>::Solve;
+
+    void Analyze(const Matrix & A) override { m_lu.analyzePattern(A); }
+    void Factorize(const Matrix & A) override
+    {
+        m_A = &A;
+        m_lu.factorize(A);
+        if (m_lu.info() != Eigen::Success) NS_TRACE("lu factorization failed, %1%", m_lu.lastErrorMessage());
+    }
+
+    /// fails with x = 0 if the factorization failed
+    bool Solve(const Vector & b, Vector & x, bool guess) override
+    {
+        NS_UNUSED(guess);
+        NS_ASSERT(m_A && m_A->rows() == b.size());
+        if (m_lu.info() != Eigen::Success) {
+            x.setZero(b.size());
+            this->summary = LinearSolveSummary{0, b.norm() > 0 ? 1.0 : 0.0, false};
+            return false;
+        }
+        x = m_lu.solve(b);
+        auto bNorm = b.norm();
+        this->summary.iterations = 1;
+        this->summary.residual = bNorm > 0 ? (b - *m_A * x).norm() / bNorm : 0;
+        this->summary.converged = m_lu.info() == Eigen::Success;
+        return this->summary.converged;
+    }
+
+private:
+    CPtr<Matrix> m_A{nullptr};//A of the last Factorize(), owned by the caller
+    Eigen::SparseLU<Matrix, Eigen::COLAMDOrdering<typename Matrix::StorageIndex>> m_lu;
+};
+
+/// non overlapping domain decomposition, G = [A_II A_IS; A_SI A_SS] with block diagonal A_II of the subdomain interiors,
+/// interiors are factored in parallel and the interface Schur complement S = A_SS - A_SI A_II^-1 A_IS is solved by pcg,
+/// preconditioned by a factorization of A_SS which keeps the strong couplings along the interface,
+/// the tolerance and the reported residual are those of the interface system, |g - S x_S| / |b| with g = b_S - A_SI A_II^-1 b_I,
+/// interiors are solved exactly, so this equals |b - Gx| / |b| of other solvers up to the rounding of the interior solves
+template <typename Scalar>
+class SchurComplementSolver : public LinearSolver<Scalar>
+{
+public:
+    using Matrix = typename LinearSolver<Scalar>::Matrix;
+    using Vector = typename LinearSolver<Scalar>::Vector;
+    using LinearSolver<Scalar>::Solve;
+    /// rows per subdomain when the number of subdomains is not set
+    inline static constexpr size_t SUBDOMAIN_SIZE = 20000;
+    explicit SchurComplementSolver(CRef<ThermalNetworkLinearSolverSettings> settings)
+     : m_subdomains(settings.subdomains), m_maxIter(settings.maxIter)
+    {
+        if (settings.tolerance > 0) m_tolerance = settings.tolerance;
+    }
+
+    void SetTolerance(Scalar tolerance) override { m_tolerance = tolerance; }
+    /// lines are kept inside one subdomain, so the interface does not cut the strong vertical couplings
+    void SetLines(Vec<Index> starts, Vec<Index> ids) override
+    {
+        m_lineStarts = std::move(starts);
+        m_lineIds = std::move(ids);
+    }
+
+    /// partition, interface selection and symbolic factorization of each interior
+    void Analyze(const Matrix & G) override
+    {
+        const size_t n = G.rows();
+        auto parts = m_subdomains > 0 ? m_subdomains : std::max<size_t>(1, n / SUBDOMAIN_SIZE);
+        auto part = dd::Partition(G, parts, m_lineStarts, m_lineIds);
+        //the row of larger part id of every cut edge joins the interface, interiors of different parts are then decoupled
+        Vec<bool> interface(n, false);
+        for (Eigen::Index j = 0; j < G.outerSize(); ++j) {
+            for (typename Matrix::InnerIterator it(G, j); it; ++it) {
+                if (part[it.row()] != part[j]) interface[part[it.row()] > part[j] ? it.row() : j] = true;
+            }
+        }
+        m_interface.clear();
+        m_domains = Vec<Domain>(parts);
+        m_local.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            auto & rows = interface[i] ? m_interface : m_domains[part[i]].interior;
+            m_local[i] = rows.size();
+            rows.emplace_back(i);
+        }
+        for (auto & domain : m_domains) {
+            for (auto j : domain.interior) {
+                for (typename Matrix::InnerIterator it(G, j); it; ++it) {
+                    if (interface[it.row()]) domain.boundary.emplace_back(m_local[it.row()]);
+                }
+            }
+            std::sort(domain.boundary.begin(), domain.boundary.end());
+            domain.boundary.erase(std::unique(domain.boundary.begin(), domain.boundary.end()), domain.boundary.end());
+        }
+        m_isInterface = std::move(interface);
+        Assemble(G);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t d = 0; d < m_domains.size(); ++d)
+            m_domains[d].ldlt.analyzePattern(m_domains[d].A);
+        m_pattern = false;
+        NS_TRACE("schur complement solver, subdomains: %1%, interface rows: %2%", m_domains.size(), m_interface.size());
+    }
+
+    /// numeric factorization of all interiors in parallel, blocks are refilled in place and symbolic factorizations are reused
+    void Factorize(const Matrix & G) override
+    {
+        NS_ASSERT(size_t(G.rows()) == m_local.size());
+        Refill(G);
+        bool success{true};
+        #pragma omp parallel for schedule(dynamic, 1) reduction(&&:success)
+        for (size_t d = 0; d < m_domains.size(); ++d) {
+            m_domains[d].ldlt.factorize(m_domains[d].A);
+            success = success && m_domains[d].ldlt.info() == Eigen::Success;
+        }
+        if (m_pattern) m_precond.factorize(m_S);
+        else {
+            m_precond.compute(m_S);
+            m_pattern = true;
+        }
+        m_factorized = success && m_precond.info() == Eigen::Success;
+        if (not m_factorized) NS_TRACE("schur complement factorization failed, subdomain or interface matrix is singular");
+    }
+
+    /// fails with x = 0 if the factorization failed
+    bool Solve(const Vector & b, Vector & x, bool guess) override
+    {
+        if (not m_factorized) {
+            x.setZero(b.size());
+            this->summary = LinearSolveSummary{0, b.norm() > 0 ? 1.0 : 0.0, false};
+            return false;
+        }
+        const Eigen::Index ns = m_interface.size();
+        Vector g(ns), xs(ns);
+        for (Eigen::Index k = 0; k < ns; ++k) {
+            g[k] = b[m_interface[k]];
+            xs[k] = guess ? x[m_interface[k]] : 0;
+        }
+        //g = b_S - A_SI A_II^-1 b_I
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t d = 0; d < m_domains.size(); ++d) {
+            auto & domain = m_domains[d];
+            domain.y.resize(domain.interior.size());
+            for (size_t i = 0; i < domain.interior.size(); ++i)
+                domain.y[i] = b[domain.interior[i]];
+            domain.rhs = domain.ldlt.solve(domain.y);
+            domain.t.noalias() = domain.B.transpose() * domain.rhs;
+        }
+        Gather(g, Scalar(-1));
+
+        auto bNorm = b.norm();
+        auto threshold = m_tolerance * bNorm;
+        auto maxIter = m_maxIter > 0 ? m_maxIter : std::max<size_t>(1, 2 * ns);
+        Vector r = g, z, p, q;
+        if (guess) { ApplySchur(xs, q); r -= q; }
+        z = m_precond.solve(r);
+        p = z;
+        Scalar rz = r.dot(z);
+        size_t iter{0};
+        for (; iter < maxIter && r.norm() > threshold; ++iter) {
+            ApplySchur(p, q);
+            Scalar alpha = rz / p.dot(q);
+            xs += alpha * p;
+            r -= alpha * q;
+            z = m_precond.solve(r);
+            Scalar rzNew = r.dot(z);
+            p = z + (rzNew / rz) * p;
+            rz = rzNew;
+        }
+
+        //x_I = A_II^-1 (b_I - A_IS x_S)
+        x.resize(b.size());
+        for (Eigen::Index k = 0; k < ns; ++k)
+            x[m_interface[k]] = xs[k];
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t d = 0; d < m_domains.size(); ++d) {
+            auto & domain = m_domains[d];
+            Scatter(domain, xs);
+            domain.y.resize(domain.interior.size());
+            for (size_t i = 0; i < domain.interior.size(); ++i)
+                domain.y[i] = b[domain.interior[i]];
+            domain.y.noalias() -= domain.B * domain.rhs;
+            domain.y = domain.ldlt.solve(domain.y);
+            for (size_t i = 0; i < domain.interior.size(); ++i)
+                x[domain.interior[i]] = domain.y[i];
+        }
+        this->summary.iterations = iter;
+        this->summary.residual = bNorm > 0 ? r.norm() / bNorm : 0;//interface residual
+        this->summary.converged = r.norm() <= threshold;
+        return this->summary.converged;
+    }
+
+private:
+    struct Domain
+    {
+        Vec<Index> interior;//rows in G
+        Vec<Index> boundary;//interface rows coupled to the interior, index in interface, sorted
+        Matrix A;//interior x interior
+        Matrix B;//interior x boundary
+        Vec<Index> aSrc, aDst;//value positions in G and in A
+        Vec<Index> bSrc, bDst;//value positions in G and in B
+        Eigen::SimplicialLDLT<Matrix, Eigen::Lower, Eigen::AMDOrdering<typename Matrix::StorageIndex>> ldlt;
+        Vector y, rhs, t;//per subdomain work vectors
+    };
+
+    /// patterns of the interior, coupling and interface blocks of G and the scatter maps from the values of G into them
+    void Assemble(const Matrix & G)
+    {
+        NS_ASSERT(G.isCompressed());
+        const auto * outer = G.outerIndexPtr();
+        const auto * inner = G.innerIndexPtr();
+        const auto * values = G.valuePtr();
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t d = 0; d < m_domains.size(); ++d) {
+            auto & domain = m_domains[d];
+            Vec<Eigen::Triplet<Scalar>> a, c;
+            domain.aSrc.clear();
+            domain.bSrc.clear();
+            for (size_t j = 0; j < domain.interior.size(); ++j) {
+                for (auto p = outer[domain.interior[j]]; p < outer[domain.interior[j] + 1]; ++p) {
+                    auto row = inner[p];
+                    if (not m_isInterface[row]) {
+                        a.emplace_back(m_local[row], j, values[p]);
+                        domain.aSrc.emplace_back(p);
+                    }
+                    else {
+                        auto iter = std::lower_bound(domain.boundary.begin(), domain.boundary.end(), m_local[row]);
+                        c.emplace_back(j, std::distance(domain.boundary.begin(), iter), values[p]);
+                        domain.bSrc.emplace_back(p);
+                    }
+                }
+            }
+            domain.A.resize(domain.interior.size(), domain.interior.size());
+            domain.A.setFromTriplets(a.begin(), a.end());
+            domain.B.resize(domain.interior.size(), domain.boundary.size());
+            domain.B.setFromTriplets(c.begin(), c.end());
+            domain.aDst = Slots(domain.A, a);
+            domain.bDst = Slots(domain.B, c);
+        }
+        Vec<Eigen::Triplet<Scalar>> s;
+        m_sSrc.clear();
+        for (size_t j = 0; j < m_interface.size(); ++j) {
+            for (auto p = outer[m_interface[j]]; p < outer[m_interface[j] + 1]; ++p) {
+                if (not m_isInterface[inner[p]]) continue;
+                s.emplace_back(m_local[inner[p]], j, values[p]);
+                m_sSrc.emplace_back(p);
+            }
+        }
+        m_S.resize(m_interface.size(), m_interface.size());
+        m_S.setFromTriplets(s.begin(), s.end());
+        m_sDst = Slots(m_S, s);
+    }
+
+    /// value position of each triplet entry in the compressed matrix m
+    static Vec<Index> Slots(const Matrix & m, const Vec<Eigen::Triplet<Scalar>> & entries)
+    {
+        Vec<Index> slots(entries.size());
+        for (size_t k = 0; k < entries.size(); ++k) {
+            auto begin = m.innerIndexPtr() + m.outerIndexPtr()[entries[k].col()];
+            auto end = m.innerIndexPtr() + m.outerIndexPtr()[entries[k].col() + 1];
+            auto iter = std::lower_bound(begin, end, entries[k].row());
+            NS_ASSERT(iter != end && *iter == entries[k].row());
+            slots[k] = std::distance(m.innerIndexPtr(), iter);
+        }
+        return slots;
+    }
+
+    /// copy the values of G into the blocks through the scatter maps, subdomains in parallel
+    void Refill(const Matrix & G)
+    {
+        NS_ASSERT(G.isCompressed());
+        const auto * values = G.valuePtr();
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t d = 0; d < m_domains.size(); ++d) {
+            auto & domain = m_domains[d];
+            for (size_t k = 0; k < domain.aSrc.size(); ++k)
+                domain.A.valuePtr()[domain.aDst[k]] = values[domain.aSrc[k]];
+            for (size_t k = 0; k < domain.bSrc.size(); ++k)
+                domain.B.valuePtr()[domain.bDst[k]] = values[domain.bSrc[k]];
+        }
+        for (size_t k = 0; k < m_sSrc.size(); ++k)
+            m_S.valuePtr()[m_sDst[k]] = values[m_sSrc[k]];
+    }
+
+    /// rhs = interface values of domain boundary
+    void Scatter(Domain & domain, const Vector & v) const
+    {
+        domain.rhs.resize(domain.boundary.size());
+        for (size_t k = 0; k < domain.boundary.size(); ++k)
+            domain.rhs[k] = v[domain.boundary[k]];
+    }
+
+    /// w += alpha * sum of subdomain t, fixed subdomain order keeps the sum independent of thread count
+    void Gather(Vector & w, Scalar alpha) const
+    {
+        for (const auto & domain : m_domains) {
+            for (size_t k = 0; k < domain.boundary.size(); ++k)
+                w[domain.boundary[k]] += alpha * domain.t[k];
+        }
+    }
+
+    /// w = S v
+    void ApplySchur(const Vector & v, Vector & w)
+    {
+        w.noalias() = m_S * v;
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t d = 0; d < m_domains.size(); ++d) {
+            auto & domain = m_domains[d];
+            Scatter(domain, v);
+            domain.y.noalias() = domain.B * domain.rhs;
+            domain.y = domain.ldlt.solve(domain.y);
+            domain.t.noalias() = domain.B.transpose() * domain.y;
+        }
+        Gather(w, Scalar(-1));
+    }
+
+    size_t m_subdomains{0};
+    size_t m_maxIter{0};
+    Scalar m_tolerance{1e-6};
+    Vec<Index> m_lineStarts, m_lineIds;
+    Vec<bool> m_isInterface;
+    Vec<Index> m_local;//row index in its interior or in the interface
+    Vec<Index> m_interface;//interface rows in G
+    Vec<Domain> m_domains;
+    Matrix m_S;//A_SS
+    Vec<Index> m_sSrc, m_sDst;//value positions in G and in A_SS
+    bool m_pattern{false};//symbolic factorization of A_SS is done
+    bool m_factorized{false};//interiors and A_SS are factorized
+    Eigen::SimplicialLDLT<Matrix, Eigen::Lower, Eigen::AMDOrdering<typename Matrix::StorageIndex>> m_precond;
+};
+
+/// jacobi pcg on a SELL-C-sigma copy of G, the matrix product is vectorized over slice lanes and each iteration is
+/// three parallel sweeps, the product with p . Gp, the x, r, z updates with r . z and the p = z + beta p update,
+/// which waits for beta, the pipelined variant is one product and one update sweep with a single fused reduction
+template <typename Scalar>
+class SellConjugateGradientSolver : public LinearSolver<Scalar>
+{
+public:
+    using Matrix = typename LinearSolver<Scalar>::Matrix;
+    using Vector = typename LinearSolver<Scalar>::Vector;
+    using LinearSolver<Scalar>::Solve;
+    explicit SellConjugateGradientSolver(CRef<ThermalNetworkLinearSolverSettings> settings)
+     : m_pipelined(settings.pipelined), m_sigma(settings.sellSigma), m_maxIter(settings.maxIter)
+    {
+        if (settings.tolerance > 0) m_tolerance = settings.tolerance;
+    }
+
+    void SetTolerance(Scalar tolerance) override { m_tolerance = tolerance; }
+    void Analyze(const Matrix & G) override
+    {
+        m_A.Analyze(G, m_sigma);
+        NS_TRACE("sell matrix, rows: %1%, nnz: %2%, padding: %3%", m_A.rows(), m_A.NonZeros(), m_A.Storage() - m_A.NonZeros());
+    }
+    void Factorize(const Matrix & G) override
+    {
+        m_A.Fill(G);
+        m_invDiag = G.diagonal().cwiseInverse();
+    }
+
+    bool Solve(const Vector & b, Vector & x, bool guess) override
+    {
+        if (not guess) x.setZero(b.size());
+        if (m_pipelined) return SolvePipelined(b, x);
+        const Eigen::Index n = b.size();
+        Vector r(n), z(n), p(n), q(n);
+        m_A.Multiply(x, q);
+        Scalar rz = 0, rr = 0, bb = 0;
+        #pragma omp parallel for schedule(static) reduction(+:rz, rr, bb)
+        for (Eigen::Index i = 0; i < n; ++i) {
+            r[i] = b[i] - q[i];
+            z[i] = m_invDiag[i] * r[i];
+            p[i] = z[i];
+            rz += r[i] * z[i];
+            rr += r[i] * r[i];
+            bb += b[i] * b[i];
+        }
+        const Scalar threshold = m_tolerance * m_tolerance * bb;
+        const size_t maxIter = m_maxIter > 0 ? m_maxIter : 2 * n;
+        size_t iter{0};
+        for (; iter < maxIter && rr > threshold; ++iter) {
+            Scalar pq = m_A.Multiply(p, q, true);
+            Scalar alpha = rz / pq, rzNew = 0;
+            rr = 0;
+            #pragma omp parallel for schedule(static) reduction(+:rzNew, rr)
+            for (Eigen::Index i = 0; i < n; ++i) {
+                x[i] += alpha * p[i];
+                r[i] -= alpha * q[i];
+                z[i] = m_invDiag[i] * r[i];
+                rzNew += r[i] * z[i];
+                rr += r[i] * r[i];
+            }
+            Scalar beta = rzNew / rz;
+            rz = rzNew;
+            #pragma omp parallel for schedule(static)
+            for (Eigen::Index i = 0; i < n; ++i)
+                p[i] = z[i] + beta * p[i];
+        }
+        this->summary.iterations = iter;
+        this->summary.residual = bb > 0 ? std::sqrt(rr / bb) : 0;
+        this->summary.converged = rr <= threshold;
+        return this->summary.converged;
+    }
+
+private:
+    /// Ghysels-Vanroose pipelined pcg, the reduction of gamma = r . u and delta = w . u is fused into the update sweep,
+    /// so each iteration is one product n = G m and one sweep over the vectors,
+    /// the recurrences drift from the true residual, so it is recomputed on exit and the iteration restarts if needed
+    bool SolvePipelined(const Vector & b, Vector & x)
+    {
+        const Eigen::Index n = b.size();
+        Vector r(n), u(n), w(n), m(n), nv(n), z(n), q(n), s(n), p(n);
+        Scalar bb = b.squaredNorm(), rr = 0;
+        const Scalar threshold = m_tolerance * m_tolerance * bb;
+        const size_t maxIter = m_maxIter > 0 ? m_maxIter : 2 * n;
+        size_t iter{0};
+        while (true) {
+            //r = b - Gx, u = M r, w = G u
+            m_A.Multiply(x, w);
+            rr = 0;
+            #pragma omp parallel for schedule(static) reduction(+:rr)
+            for (Eigen::Index i = 0; i < n; ++i) {
+                r[i] = b[i] - w[i];
+                u[i] = m_invDiag[i] * r[i];
+                rr += r[i] * r[i];
+            }
+            if (rr <= threshold || iter >= maxIter) break;
+            m_A.Multiply(u, w);
+            Scalar gamma = 0, delta = 0;
+            #pragma omp parallel for schedule(static) reduction(+:gamma, delta)
+            for (Eigen::Index i = 0; i < n; ++i) {
+                m[i] = m_invDiag[i] * w[i];
+                gamma += r[i] * u[i];
+                delta += w[i] * u[i];
+            }
+            //the direction recurrences start from zero, beta = 0 alone does not clear garbage or NaN of a new vector
+            z.setZero(); q.setZero(); s.setZero(); p.setZero();
+            auto start = iter;
+            Scalar alpha = 0, gammaOld = 0;
+            for (; iter < maxIter && rr > threshold; ++iter) {
+                m_A.Multiply(m, nv);
+                Scalar beta = iter == start ? 0 : gamma / gammaOld;
+                alpha = iter == start ? gamma / delta : gamma / (delta - beta * gamma / alpha);
+                gammaOld = gamma;
+                gamma = 0; delta = 0; rr = 0;
+                #pragma omp parallel for schedule(static) reduction(+:gamma, delta, rr)
+                for (Eigen::Index i = 0; i < n; ++i) {
+                    z[i] = nv[i] + beta * z[i];
+                    q[i] = m[i] + beta * q[i];
+                    s[i] = w[i] + beta * s[i];
+                    p[i] = u[i] + beta * p[i];
+                    x[i] += alpha * p[i];
+                    r[i] -= alpha * s[i];
+                    u[i] -= alpha * q[i];
+                    w[i] -= alpha * z[i];
+                    m[i] = m_invDiag[i] * w[i];
+                    gamma += r[i] * u[i];
+                    delta += w[i] * u[i];
+                    rr += r[i] * r[i];
+                }
+            }
+            if (iter == start) break;
+        }
+        this->summary.iterations = iter;
+        this->summary.residual = bb > 0 ? std::sqrt(rr / bb) : 0;
+        this->summary.converged = rr <= threshold;
+        return this->summary.converged;
+    }
+
+    bool m_pipelined;
+    size_t m_sigma;
+    size_t m_maxIter;
+    Scalar m_tolerance{1e-6};
+    SellMatrix<Scalar> m_A;
+    Vector m_invDiag;
+};
+
+/// iterative refinement, G and the residuals b - Gx stay in Scalar while the inner solver factors and iterates on a float copy of G,
+/// corrections only need a loose relative tolerance, the refined x reaches the requested tolerance in Scalar precision
+template <typename Scalar>
+class MixedPrecisionSolver : public LinearSolver<Scalar>
+{
+public:
+    using Matrix = typename LinearSolver<Scalar>::Matrix;
+    using Vector = typename LinearSolver<Scalar>::Vector;
+    using Inner = LinearSolver<Float32>;
+    using LinearSolver<Scalar>::Solve;
+    /// relative tolerance of each correction solve
+    inline static constexpr Float32 INNER_TOLERANCE = 1e-4;
+    inline static constexpr size_t MAX_REFINEMENTS = 30;
+    MixedPrecisionSolver(UPtr<Inner> inner, CRef<ThermalNetworkLinearSolverSettings> settings) : m_inner(std::move(inner))
+    {
+        NS_ASSERT(m_inner);
+        if (settings.tolerance > 0) m_tolerance = settings.tolerance;
+        m_inner->SetTolerance(INNER_TOLERANCE);
+    }
+
+    void SetTolerance(Scalar tolerance) override { m_tolerance = tolerance; }
+    void SetLines(Vec<Index> starts, Vec<Index> ids) override { m_inner->SetLines(std::move(starts), std::move(ids)); }
+    void Analyze(const Matrix & G) override
+    {
+        m_G32 = G.template cast<Float32>();
+        m_inner->Analyze(m_G32);
+    }
+    void Factorize(const Matrix & G) override
+    {
+        NS_ASSERT(G.nonZeros() == m_G32.nonZeros());
+        m_G = &G;
+        std::transform(G.valuePtr(), G.valuePtr() + G.nonZeros(), m_G32.valuePtr(), [](auto v) { return Float32(v); });
+        m_inner->Factorize(m_G32);
+    }
+
+    bool Solve(const Vector & b, Vector & x, bool guess) override
+    {
+        NS_ASSERT(m_G);
+        if (not guess) x.setZero(b.size());
+        auto bNorm = b.norm();
+        LinearSolveSummary total{0, 0, false};
+        Vector r, prev;
+        typename Inner::Vector r32, d32;
+        for (size_t k = 0; ; ++k) {
+            r = b - *m_G * x;
+            auto residual = bNorm > 0 ? r.norm() / bNorm : 0;
+            //stops on convergence or when a correction no longer reduces the residual, which is then undone
+            if (k > 0 && residual >= total.residual) {
+                x = prev;
+                break;
+            }
+            total.residual = residual;
+            if (residual <= m_tolerance) { total.converged = true; break; }
+            if (MAX_REFINEMENTS == k) break;
+            r32 = r.template cast<Float32>();
+            m_inner->Solve(r32, d32, false);
+            total.iterations += m_inner->summary.iterations;
+            prev = x;
+            x += d32.template cast<Scalar>();
+        }
+        this->summary = total;
+        return this->summary.converged;
+    }
+
+private:
+    Scalar m_tolerance{1e-6};
+    CPtr<Matrix> m_G{nullptr};
+    typename Inner::Matrix m_G32;
+    UPtr<Inner> m_inner;
+};
+
+template <typename Scalar>
+inline UPtr<LinearSolver<Scalar>> CreateLinearSolver(CRef<ThermalNetworkLinearSolverSettings> settings)
+{
+    using Solver = ThermalNetworkLinearSolverSettings::Solver;
+    using Preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner;
+    if constexpr (not std::is_same_v<Scalar, Float32>) {
+        if (settings.mixedPrecision) {
+            auto inner = settings;
+            inner.mixedPrecision = false;
+            return std::make_unique<MixedPrecisionSolver<Scalar>>(CreateLinearSolver<Float32>(inner), settings);
+        }
+    }
+    else if (settings.mixedPrecision) NS_TRACE("mixed precision needs a double precision network, the solve stays in float");
+    if (Solver::LDLT == settings.solver)
+        return std::make_unique<CholeskySolver<Scalar>>();
+    if (Solver::SCHUR == settings.solver)
+        return std::make_unique<SchurComplementSolver<Scalar>>(settings);
+    if (Solver::SELL_CG == settings.solver)
+        return std::make_unique<SellConjugateGradientSolver<Scalar>>(settings);
+
+    switch (settings.preconditioner) {
+        case Preconditioner::JACOBI : {
+            return std::make_unique<ConjugateGradientSolver<Scalar, Eigen::DiagonalPreconditioner<Scalar>>>(settings);
+        }
+        case Preconditioner::INCOMPLETE_CHOLESKY : {
+            auto solver = std::make_unique<ConjugateGradientSolver<Scalar, IncompleteCholeskyPreconditioner<Scalar>>>(settings);
+            solver->GetPreconditioner().setFillLevel(settings.icFillLevel);
+            solver->GetPreconditioner().setInitialShift(settings.icShift);
+            return solver;
+        }
+        case Preconditioner::SSOR : {
+            auto solver = std::make_unique<ConjugateGradientSolver<Scalar, SSORPreconditioner<Scalar>>>(settings);
+            solver->GetPreconditioner().setOmega(settings.ssorOmega);
+            return solver;
+        }
+        case Preconditioner::LINE : {
+            return std::make_unique<ConjugateGradientSolver<Scalar, LinePreconditioner<Scalar>>>(settings);
+        }
+        case Preconditioner::AMG : {
+            using AMG = SmoothedAggregationAMG<Scalar>;
+            auto solver = std::make_unique<ConjugateGradientSolver<Scalar, AMG>>(settings);
+            auto & amg = solver->GetPreconditioner();
+            amg.setSmoother(ThermalNetworkLinearSolverSettings::Smoother::JACOBI == settings.amgSmoother ? AMG::Smoother::JACOBI : AMG::Smoother::CHEBYSHEV);
+            amg.setSmoothSteps(settings.amgSmoothSteps);
+            amg.setCoarseSize(settings.amgCoarseSize);
+            amg.setStrength(settings.amgStrength);
+            return solver;
+        }
+    }
+    NS_ASSERT(false);
+    return nullptr;
+}
+
+} // namespace nano::heat::solver::network
@@ -0,0 +1,223 @@
+#pragma once
+#include "NSThermalNetwork.hpp"
+#include "NSThermalNetworkLinearSolver.hpp"
+
+#include <Eigen/Eigenvalues>
+#ifdef NANO_BOOST_SERIALIZATION_SUPPORT
+#include <boost/serialization/array_wrapper.hpp>
+#endif//NANO_BOOST_SERIALIZATION_SUPPORT
+namespace nano::heat::solver::network {
+
+/// PRIMA reduced model of C x' + G x = B u(t) with probe outputs y = L^T x, x is the deviation from a uniform initial state,
+/// ports are the power distribution of each scenario plus one constant load port, u = [excitation(t, scenario)..., 1],
+/// heat flow that is not scenario power (e.g. boundary heat flux) is part of the constant load,
+/// the congruence projection keeps the reduced G, C symmetric positive (semi) definite, so the reduced system is
+/// diagonalized into decoupled modes tau w' + w = b u that are integrated exactly for inputs linear in each step,
+/// the model does not refer to the network and can be kept or archived for repeated transients
+template <typename Scalar>
+class ThermalNetworkReducedModel
+{
+public:
+    using Matrix = DenseMatrix<Scalar>;
+    using Vector = DenseVector<Scalar>;
+    /// columns removed by block arnoldi when orthogonalization leaves less than this fraction of their norm
+    inline static constexpr Scalar DEFLATION_TOLERANCE = 1e-10;
+
+    size_t topology = 0;//topology of the network the model is reduced from
+    size_t values = 0;//hash of the node and conductance values of the network and the temperatures of Build
+    size_t request = 0;//order asked by Build, deflation may end with less modes
+    Vec<Index> probes;//node index of each output
+    Vec<Index> scenarios;//scenario of each power port, the constant load port follows them
+    Vector offset;//probe temperatures of the initial state
+    Vector taus;//time constant of each mode, unit: s
+    Matrix inputs;//modes x ports
+    Matrix outputs;//probes x modes
+
+    size_t Order() const { return taus.size(); }
+    size_t PortSize() const { return scenarios.size() + 1; }
+
+    bool isValid(CRef<ThermalNetwork<Scalar>> network, Scalar refT, Scalar x0, const Vec<Index> & probes, size_t order) const
+    {
+        return Order() > 0 && request == order && topology == network.Topology() && this->probes == probes &&
+               values == HashValues(network, refT, x0);
+    }
+
+    /// G, C and B follow from these values, any change of them invalidates the model
+    static size_t HashValues(CRef<ThermalNetwork<Scalar>> network, Scalar refT, Scalar x0)
+    {
+        size_t seed{0};
+        boost::hash_combine(seed, refT);
+        boost::hash_combine(seed, x0);
+        for (size_t i = 0; i < network.NodeSize(); ++i) {
+            const auto & node = network[i];
+            boost::hash_combine(seed, node.scen);
+            boost::hash_combine(seed, node.t);
+            boost::hash_combine(seed, node.c);
+            boost::hash_combine(seed, node.hf);
+            boost::hash_combine(seed, node.power);
+            boost::hash_combine(seed, node.htc);
+            auto gs = network.Conductances(i);
+            boost::hash_combine(seed, boost::hash_range(gs.begin(), gs.end()));
+        }
+        return seed;
+    }
+
+    /// block arnoldi on G^-1 C from G^-1 B up to order columns, x0: uniform initial temperature,
+    /// G is factorized once by the configured linear solver and every block is one batched solve against it
+    void Build(CRef<ThermalNetwork<Scalar>> network, Scalar refT, Scalar x0, const Vec<Index> & probes, size_t order,
+               CRef<ThermalNetworkLinearSolverSettings> settings = {})
+    {
+        const size_t n = network.MatrixSize();
+        topology = network.Topology();
+        values = HashValues(network, refT, x0);
+        request = order;
+        this->probes = probes;
+        Vec<Index> unknowns;
+        for (auto p : probes) {
+            if (network[p].t == network.UNKNOWN_T) unknowns.emplace_back(p);
+        }
+        auto mna = makeMNA(network, unknowns);
+
+        //ports: B W, W maps every source to its scenario port or to the constant load port
+        scenarios.clear();
+        HashMap<Index, Index> ports;
+        const auto & sources = network.Sources();
+        for (auto nid : sources) {
+            const auto & node = network[nid];
+            if (0 == node.power || INVALID_INDEX == node.scen) continue;
+            if (ports.emplace(node.scen, scenarios.size()).second) scenarios.emplace_back(node.scen);
+        }
+        Vec<Eigen::Triplet<Scalar>> triplets;
+        for (size_t s = 0; s < sources.size(); ++s) {
+            const auto & node = network[sources[s]];
+            auto load = makeSourceRhs(network, sources[s], refT);
+            if (auto iter = ports.find(node.scen); 0 != node.power && iter != ports.cend()) {
+                triplets.emplace_back(s, iter->second, node.power);
+                load -= node.power;
+            }
+            triplets.emplace_back(s, scenarios.size(), load);
+        }
+        SparseMatrix<Scalar> W(sources.size(), PortSize());
+        W.setFromTriplets(triplets.begin(), triplets.end());
+        Matrix B = mna.B * W;
+        B.col(scenarios.size()) -= mna.G * Vector::Constant(n, x0);
+
+        auto solver = CreateLinearSolver<Scalar>(settings);
+        Vec<Index> starts, ids;
+        makeMatrixColumns(network, starts, ids);
+        solver->SetLines(std::move(starts), std::move(ids));
+        solver->Analyze(mna.G);
+        solver->Factorize(mna.G);
+
+        //orthonormal basis V by two pass gram schmidt with deflation
+        order = std::min(order, n);
+        Matrix V(n, order), R, CV;
+        size_t q{0};
+        auto append = [&](Vector w) {
+            auto norm0 = w.norm();
+            for (size_t pass = 0; pass < 2 && q > 0; ++pass)
+                w -= V.leftCols(q) * (V.leftCols(q).transpose() * w);
+            auto norm = w.norm();
+            if (q == order || 0 == norm0 || norm <= DEFLATION_TOLERANCE * norm0) return false;
+            V.col(q++) = w / norm;
+            return true;
+        };
+        const Vector c = mna.C.diagonal();
+        solver->Solve(B, R);
+        for (Vec<Index> block, next; ; block.swap(next)) {
+            next.clear();
+            for (Eigen::Index j = 0; j < R.cols(); ++j) {
+                if (append(R.col(j))) next.emplace_back(q - 1);
+            }
+            if (next.empty() || q == order) break;
+            CV.resize(n, next.size());
+            for (size_t j = 0; j < next.size(); ++j)
+                CV.col(j) = c.cwiseProduct(V.col(next[j]));
+            solver->Solve(CV, R);
+        }
+        V.conservativeResize(n, q);
+        NS_TRACE("PRIMA reduction, nodes: %1%, ports: %2%, order: %3%", n, PortSize(), q);
+
+        //modes of C_r v = tau G_r v, normalized to v^T G_r v = 1
+        Matrix Gr = V.transpose() * (mna.G * V);
+        Matrix Cr = V.transpose() * c.asDiagonal() * V;
+        Eigen::GeneralizedSelfAdjointEigenSolver<Matrix> modes(Cr, Gr);
+        NS_ASSERT(modes.info() == Eigen::Success);
+        taus = modes.eigenvalues().cwiseMax(0);
+        inputs = modes.eigenvectors().transpose() * (V.transpose() * B);
+
+        Matrix Lr = mna.L.transpose() * V;
+        outputs = Matrix::Zero(probes.size(), q);
+        offset.resize(probes.size());
+        for (size_t p = 0, u = 0; p < probes.size(); ++p) {
+            if (auto t = network[probes[p]].t; network.UNKNOWN_T != t) {
+                offset[p] = t;
+                continue;
+            }
+            offset[p] = x0;
+            outputs.row(p) = Lr.row(u++) * modes.eigenvectors();
+        }
+    }
+
+    /// fixed step sampling of the probe temperatures from the initial state, observer(time, y) is called at time 0 and after
+    /// every step, each mode is exact for inputs linear within a step, so step only sets how finely excitation and output are sampled
+    template <typename Observer>
+    void Simulate(CRef<ThermalTransientExcitation> excitation, Scalar duration, Scalar step, Observer && observer) const
+    {
+        NS_ASSERT(step > 0);
+        Vector u(PortSize()), w = Vector::Zero(Order()), y = offset;
+        auto input = [&](Scalar time) -> Vector {
+            for (size_t s = 0; s < scenarios.size(); ++s)
+                u[s] = excitation(time, scenarios[s]);
+            u[scenarios.size()] = 1;
+            return inputs * u;
+        };
+        Scalar time = 0;
+        Vector beta0 = input(time), beta1;
+        observer(time, y);
+        while (duration - time > Scalar(1e-6) * step) {
+            auto h = std::min(step, duration - time);
+            beta1 = input(time + h);
+            for (size_t i = 0; i < Order(); ++i) {
+                if (taus[i] <= 0) {
+                    w[i] = beta1[i];
+                    continue;
+                }
+                //w(h) = (w0 - beta0 + tau s) e^(-h / tau) + beta1 - tau s, s = (beta1 - beta0) / h
+                auto ts = taus[i] * (beta1[i] - beta0[i]) / h;
+                w[i] = (w[i] - beta0[i] + ts) * std::exp(-h / taus[i]) + beta1[i] - ts;
+            }
+            std::swap(beta0, beta1);
+            time += h;
+            y = offset + outputs * w;
+            observer(time, y);
+        }
+    }
+
+#ifdef NANO_BOOST_SERIALIZATION_SUPPORT
+    friend class boost::serialization::access;
+    template <typename Archive>
+    void serialize(Archive & ar, const unsigned int version)
+    {
+        NS_UNUSED(version);
+        auto matrix = [&ar](const char * name, auto & m) {
+            Eigen::Index rows = m.rows(), cols = m.cols();
+            ar & boost::serialization::make_nvp((std::string(name) + "_rows").c_str(), rows);
+            ar & boost::serialization::make_nvp((std::string(name) + "_cols").c_str(), cols);
+            if constexpr (Archive::is_loading::value) m.resize(rows, cols);
+            ar & boost::serialization::make_nvp(name, boost::serialization::make_array(m.data(), m.size()));
+        };
+        ar & boost::serialization::make_nvp("topology", topology);
+        ar & boost::serialization::make_nvp("values", values);
+        ar & boost::serialization::make_nvp("request", request);
+        ar & boost::serialization::make_nvp("probes", probes);
+        ar & boost::serialization::make_nvp("scenarios", scenarios);
+        matrix("offset", offset);
+        matrix("taus", taus);
+        matrix("inputs", inputs);
+        matrix("outputs", outputs);
+    }
+#endif//NANO_BOOST_SERIALIZATION_SUPPORT
+};
+
+} // namespace nano::heat::solver::network
@@ -0,0 +1,161 @@
+#pragma once
+#include "NSThermalNetworkLinearSolver.hpp"
+#include "NSThermalNetwork.hpp"
+
+namespace nano::heat::solver::network {
+template <typename Scalar> class ThermalNetworkOperator;
+} // namespace nano::heat::solver::network
+
+namespace Eigen::internal {
+template <typename Scalar>
+struct traits<nano::heat::solver::network::ThermalNetworkOperator<Scalar>> : public traits<SparseMatrix<Scalar>> {};
+} // namespace Eigen::internal
+
+namespace nano::heat::solver::network {
+
+/// conductance matrix G applied directly from the network face table, no sparse matrix is assembled,
+/// memory is one diagonal vector on top of the network, rows are in matrix order
+template <typename S>
+class ThermalNetworkOperator : public Eigen::EigenBase<ThermalNetworkOperator<S>>
+{
+public:
+    using Scalar = S;
+    using RealScalar = S;
+    using StorageIndex = int;
+    enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic, IsRowMajor = false };
+
+    Eigen::Index rows() const { return m_diag.size(); }
+    Eigen::Index cols() const { return m_diag.size(); }
+
+    void Attach(CRef<ThermalNetwork<Scalar>> network)
+    {
+        m_network = &network;
+        m_diag.resize(network.MatrixSize());
+        #pragma omp parallel for schedule(static)
+        for (Eigen::Index mid = 0; mid < Eigen::Index(network.MatrixSize()); ++mid) {
+            auto nid = network.NodeId(mid);
+            Scalar diag = network[nid].htc;
+            for (auto g : network.Conductances(nid)) diag += g;
+            m_diag[mid] = diag;
+        }
+    }
+
+    /// G += diag(d), d in matrix order
+    void AddDiagonal(const DenseVector<Scalar> & d) { m_diag += d; }
+
+    const DenseVector<Scalar> & Diagonal() const { return m_diag; }
+
+    Scalar coeff(Eigen::Index i, Eigen::Index j) const
+    {
+        if (i == j) return m_diag[i];
+        auto n1 = m_network->NodeId(i), n2 = m_network->NodeId(j);
+        auto ns = m_network->Neighbors(n1);
+        auto iter = std::lower_bound(ns.begin(), ns.end(), n2);
+        if (iter == ns.end() || *iter != n2) return 0;
+        return -m_network->Conductances(n1)[std::distance(ns.begin(), iter)];
+    }
+
+    template <typename Rhs>
+    Eigen::Product<ThermalNetworkOperator, Rhs, Eigen::AliasFreeProduct> operator* (const Eigen::MatrixBase<Rhs> & x) const
+    {
+        return Eigen::Product<ThermalNetworkOperator, Rhs, Eigen::AliasFreeProduct>(*this, x.derived());
+    }
+
+    /// y += alpha * G x, rows in parallel
+    template <typename Rhs, typename Dest>
+    void Apply(const Rhs & x, Dest & y, Scalar alpha) const
+    {
+        NS_ASSERT(m_network);
+        const auto & network = *m_network;
+        #pragma omp parallel for schedule(static)
+        for (Eigen::Index mid = 0; mid < rows(); ++mid) {
+            auto nid = network.NodeId(mid);
+            auto ns = network.Neighbors(nid);
+            auto gs = network.Conductances(nid);
+            Scalar sum = m_diag[mid] * x[mid];
+            for (size_t k = 0; k < ns.size(); ++k) {
+                if (network[ns[k]].t == network.UNKNOWN_T)
+                    sum -= gs[k] * x[network.MatrixId(ns[k])];
+            }
+            y[mid] += alpha * sum;
+        }
+    }
+
+private:
+    CPtr<ThermalNetwork<Scalar>> m_network{nullptr};
+    DenseVector<Scalar> m_diag;
+};
+
+/// conjugate gradient on its own ThermalNetworkOperator, preconditioned by column line relaxation or point jacobi,
+/// the network is attached through GetOperator(), the sparse matrix arguments of LinearSolver are ignored
+template <typename Scalar>
+class MatrixFreeSolver : public LinearSolver<Scalar>
+{
+public:
+    using Matrix = typename LinearSolver<Scalar>::Matrix;
+    using Vector = typename LinearSolver<Scalar>::Vector;
+    using Operator = ThermalNetworkOperator<Scalar>;
+    using LinearSolver<Scalar>::Solve;
+    explicit MatrixFreeSolver(CRef<ThermalNetworkLinearSolverSettings> settings)
+    {
+        using Preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner;
+        m_lines = Preconditioner::LINE == settings.preconditioner;
+        if (not m_lines && Preconditioner::JACOBI != settings.preconditioner)
+            NS_TRACE("matrix free solver supports jacobi and line preconditioners only, jacobi is used");
+        if (settings.tolerance > 0) m_cg.setTolerance(settings.tolerance);
+        if (settings.maxIter > 0) m_cg.setMaxIterations(settings.maxIter);
+    }
+
+    Operator & GetOperator() { return m_op; }
+
+    void SetTolerance(Scalar tolerance) override { m_cg.setTolerance(tolerance); }
+    void SetLines(Vec<Index> starts, Vec<Index> ids) override
+    {
+        if (m_lines) m_cg.preconditioner().setLines(std::move(starts), std::move(ids));
+    }
+    void Analyze(const Matrix & G) override { NS_UNUSED(G); m_cg.analyzePattern(m_op); }
+    void Factorize(const Matrix & G) override
+    {
+        NS_UNUSED(G);
+        m_cg.factorize(m_op);
+        if (m_lines && m_cg.preconditioner().info() != Eigen::Success) {
+            //a line with a non positive pivot, the lines are dropped and the preconditioner is point jacobi from now on
+            NS_TRACE("line preconditioner factorization failed, fall back to jacobi");
+            m_lines = false;
+            m_cg.preconditioner().setLines({}, {});
+            m_cg.analyzePattern(m_op);
+            m_cg.factorize(m_op);
+        }
+    }
+
+    bool Solve(const Vector & b, Vector & x, bool guess) override
+    {
+        if (guess) x = m_cg.solveWithGuess(b, x);
+        else x = m_cg.solve(b);
+        this->summary.iterations = m_cg.iterations();
+        this->summary.residual = m_cg.error();
+        this->summary.converged = m_cg.info() == Eigen::Success;
+        return this->summary.converged;
+    }
+
+private:
+    bool m_lines{false};
+    Operator m_op;
+    Eigen::ConjugateGradient<Operator, Eigen::Lower | Eigen::Upper, LinePreconditioner<Scalar>> m_cg;
+};
+
+} // namespace nano::heat::solver::network
+
+namespace Eigen::internal {
+template <typename Scalar, typename Rhs>
+struct generic_product_impl<nano::heat::solver::network::ThermalNetworkOperator<Scalar>, Rhs, SparseShape, DenseShape, GemvProduct>
+ : generic_product_impl_base<nano::heat::solver::network::ThermalNetworkOperator<Scalar>, Rhs, generic_product_impl<nano::heat::solver::network::ThermalNetworkOperator<Scalar>, Rhs>>
+{
+    using Operator = nano::heat::solver::network::ThermalNetworkOperator<Scalar>;
+    template <typename Dest>
+    static void scaleAndAddTo(Dest & dst, const Operator & lhs, const Rhs & rhs, const Scalar & alpha)
+    {
+        lhs.Apply(rhs, dst, alpha);
+    }
+};
+} // namespace Eigen::internal
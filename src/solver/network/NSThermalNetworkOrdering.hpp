@@ -0,0 +1,211 @@
+#pragma once
+#include "NSThermalNetwork.hpp"
+
+#include <algorithm>
+#include <numeric>
+namespace nano::heat::solver::network {
+
+/// envelope of G in the current matrix order, bandwidth: max |i - j|, profile: sum over rows of i - min j
+struct OrderingReport
+{
+    size_t bandwidth = 0;
+    size_t profile = 0;
+};
+
+template <typename Scalar>
+inline OrderingReport makeOrderingReport(const ThermalNetwork<Scalar> & network)
+{
+    OrderingReport report;
+    for (size_t mid = 0; mid < network.MatrixSize(); ++mid) {
+        auto first = mid;
+        for (auto n : network.Neighbors(network.NodeId(mid))) {
+            if (network[n].t != network.UNKNOWN_T) continue;
+            auto col = network.MatrixId(n);
+            first = std::min(first, col);
+            report.bandwidth = std::max(report.bandwidth, col > mid ? col - mid : mid - col);
+        }
+        report.profile += mid - first;
+    }
+    return report;
+}
+
+namespace ordering {
+
+/// adjacency of the unknown nodes in matrix ids
+template <typename Scalar>
+inline void makeMatrixGraph(const ThermalNetwork<Scalar> & network, Vec<Index> & starts, Vec<Index> & adjacency)
+{
+    starts.assign(network.MatrixSize() + 1, 0);
+    adjacency.clear();
+    for (size_t mid = 0; mid < network.MatrixSize(); ++mid) {
+        for (auto n : network.Neighbors(network.NodeId(mid))) {
+            if (network[n].t == network.UNKNOWN_T) adjacency.emplace_back(network.MatrixId(n));
+        }
+        starts[mid + 1] = adjacency.size();
+    }
+}
+
+/// breadth first search within vertices of group tag, appends the visited vertices to queue, neighbors in ascending degree when sorted
+inline void BFS(const Vec<Index> & starts, const Vec<Index> & adjacency, const Vec<size_t> & group, size_t tag,
+                Vec<size_t> & visit, size_t stamp, Index seed, Vec<Index> & queue, bool sorted = false)
+{
+    auto degree = [&](Index v) { return starts[v + 1] - starts[v]; };
+    auto head = queue.size();
+    visit[seed] = stamp;
+    queue.emplace_back(seed);
+    for (; head < queue.size(); ++head) {
+        auto v = queue[head];
+        auto begin = queue.size();
+        for (auto k = starts[v]; k < starts[v + 1]; ++k) {
+            auto u = adjacency[k];
+            if (group[u] != tag || visit[u] == stamp) continue;
+            visit[u] = stamp;
+            queue.emplace_back(u);
+        }
+        if (sorted) std::stable_sort(queue.begin() + begin, queue.end(), [&](Index a, Index b) { return degree(a) < degree(b); });
+    }
+}
+
+/// vertex of group tag far from seed, end of the second of two breadth first sweeps
+inline Index PeripheralVertex(const Vec<Index> & starts, const Vec<Index> & adjacency, const Vec<size_t> & group, size_t tag,
+                              Vec<size_t> & visit, size_t & stamp, Index seed, Vec<Index> & queue)
+{
+    for (size_t sweep = 0; sweep < 2; ++sweep) {
+        queue.clear();
+        BFS(starts, adjacency, group, tag, visit, ++stamp, seed, queue);
+        seed = queue.back();
+    }
+    return seed;
+}
+
+/// d of Hilbert curve of order 2^16 through cell (x, y)
+inline uint64_t HilbertKey(uint32_t x, uint32_t y)
+{
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) > 0, ry = (y & s) > 0;
+        d += uint64_t(s) * s * ((3 * rx) ^ ry);
+        if (0 == ry) {
+            if (1 == rx) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+} // namespace ordering
+
+/// reverse Cuthill-McKee, order[new matrix id] = old matrix id, each component starts from a pseudo peripheral node
+template <typename Scalar>
+inline Vec<Index> makeRCMOrdering(const ThermalNetwork<Scalar> & network)
+{
+    const size_t n = network.MatrixSize();
+    Vec<Index> starts, adjacency, order, queue;
+    ordering::makeMatrixGraph(network, starts, adjacency);
+    Vec<size_t> group(n, 0), visit(n, 0);
+    size_t stamp{0};
+    Vec<bool> done(n, false);
+    order.reserve(n);
+    for (size_t v = 0; v < n; ++v) {
+        if (done[v]) continue;
+        auto seed = ordering::PeripheralVertex(starts, adjacency, group, 0, visit, stamp, v, queue);
+        queue.clear();
+        ordering::BFS(starts, adjacency, group, 0, visit, ++stamp, seed, queue, true);
+        for (auto u : queue) done[u] = true;
+        order.insert(order.end(), queue.begin(), queue.end());
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/// nested dissection, order[new matrix id] = old matrix id, level structure bisection with the separator numbered last,
+/// sets up to leaf size keep their breadth first order
+template <typename Scalar>
+inline Vec<Index> makeNestedDissectionOrdering(const ThermalNetwork<Scalar> & network, size_t leaf = 64)
+{
+    const size_t n = network.MatrixSize();
+    Vec<Index> starts, adjacency, order, queue;
+    ordering::makeMatrixGraph(network, starts, adjacency);
+    Vec<size_t> group(n, 0), visit(n, 0);
+    size_t groups{0}, stamp{0};
+    order.reserve(n);
+
+    auto dissect = [&](auto && self, Vec<Index> vertices) -> void {
+        auto tag = group[vertices.front()];
+        //breadth first order of all components of the set
+        auto seed = ordering::PeripheralVertex(starts, adjacency, group, tag, visit, stamp, vertices.front(), queue);
+        queue.clear();
+        ++stamp;
+        ordering::BFS(starts, adjacency, group, tag, visit, stamp, seed, queue);
+        for (auto v : vertices) {
+            if (visit[v] != stamp) ordering::BFS(starts, adjacency, group, tag, visit, stamp, v, queue);
+        }
+        if (queue.size() <= leaf) {
+            order.insert(order.end(), queue.begin(), queue.end());
+            return;
+        }
+        //second half touching the first half is the separator
+        auto mid = queue.size() / 2;
+        Vec<Index> first(queue.begin(), queue.begin() + mid), second, separator;
+        auto tagFirst = ++groups, tagSecond = ++groups, tagSeparator = ++groups;
+        for (auto v : first) group[v] = tagFirst;
+        for (auto i = mid; i < queue.size(); ++i) {
+            auto v = queue[i];
+            bool cut = false;
+            for (auto k = starts[v]; k < starts[v + 1] && not cut; ++k)
+                cut = group[adjacency[k]] == tagFirst;
+            (cut ? separator : second).emplace_back(v);
+        }
+        for (auto v : second) group[v] = tagSecond;
+        for (auto v : separator) group[v] = tagSeparator;
+        self(self, std::move(first));
+        if (not second.empty()) self(self, std::move(second));
+        order.insert(order.end(), separator.begin(), separator.end());
+    };
+    if (n > 0) {
+        Vec<Index> all(n);
+        std::iota(all.begin(), all.end(), 0);
+        dissect(dissect, std::move(all));
+    }
+    NS_ASSERT(order.size() == n);
+    return order;
+}
+
+/// spatial ordering along a Hilbert curve over x, y of points (node order), ties in the same cell are ordered by z,
+/// order[new matrix id] = old matrix id
+template <typename Scalar>
+inline Vec<Index> makeHilbertOrdering(const ThermalNetwork<Scalar> & network, const Vec<Arr3<Float>> & points)
+{
+    NS_ASSERT(points.size() == network.NodeSize());
+    const size_t n = network.MatrixSize();
+    Float lower[2] = {std::numeric_limits<Float>::max(), std::numeric_limits<Float>::max()};
+    Float upper[2] = {-lower[0], -lower[1]};
+    for (size_t mid = 0; mid < n; ++mid) {
+        const auto & p = points[network.NodeId(mid)];
+        for (size_t i = 0; i < 2; ++i) {
+            lower[i] = std::min(lower[i], p[i]);
+            upper[i] = std::max(upper[i], p[i]);
+        }
+    }
+    auto cell = [&](Float v, size_t i) {
+        auto range = upper[i] - lower[i];
+        return range > 0 ? uint32_t(std::min<Float>(65535, (v - lower[i]) / range * 65536)) : 0u;
+    };
+    Vec<uint64_t> keys(n);
+    for (size_t mid = 0; mid < n; ++mid) {
+        const auto & p = points[network.NodeId(mid)];
+        keys[mid] = ordering::HilbertKey(cell(p[0], 0), cell(p[1], 1));
+    }
+    Vec<Index> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](Index a, Index b) {
+        if (keys[a] != keys[b]) return keys[a] < keys[b];
+        return points[network.NodeId(a)][2] < points[network.NodeId(b)][2];
+    });
+    return order;
+}
+
+} // namespace nano::heat::solver::network
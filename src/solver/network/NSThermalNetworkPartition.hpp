@@ -0,0 +1,128 @@
+#pragma once
+#include "basic/NSHeatAlias.hpp"
+
+#include <Eigen/Sparse>
+#include <numeric>
+namespace nano::heat::solver::network {
+
+namespace dd {
+
+/// recursive level structure bisection of a weighted graph in CSR form into parts, returns the part id of each vertex,
+/// every bisection orders its vertices by breadth first search from a pseudo peripheral vertex and cuts at the weight ratio
+inline Vec<Index> Bisect(const Vec<Index> & starts, const Vec<Index> & adjacency, const Vec<size_t> & weights, size_t parts)
+{
+    const size_t n = weights.size();
+    Vec<Index> part(n, 0);
+    if (parts < 2 || n < parts) return part;
+
+    struct Range { size_t begin, end, parts; Index first; };
+    Vec<Index> order(n), queue;
+    std::iota(order.begin(), order.end(), 0);
+    Vec<size_t> group(n, 0), visit(n, 0);
+    size_t groups{0}, stamp{0};
+    queue.reserve(n);
+
+    //appends vertices reachable from seed within group tag to queue
+    auto bfs = [&](Index seed, size_t tag) {
+        auto head = queue.size();
+        visit[seed] = stamp;
+        queue.emplace_back(seed);
+        for (; head < queue.size(); ++head) {
+            auto v = queue[head];
+            for (auto k = starts[v]; k < starts[v + 1]; ++k) {
+                auto u = adjacency[k];
+                if (group[u] != tag || visit[u] == stamp) continue;
+                visit[u] = stamp;
+                queue.emplace_back(u);
+            }
+        }
+    };
+
+    Vec<Range> stack{{0, n, parts, 0}};
+    while (not stack.empty()) {
+        auto range = stack.back();
+        stack.pop_back();
+        if (range.parts < 2) {
+            for (auto i = range.begin; i < range.end; ++i)
+                part[order[i]] = range.first;
+            continue;
+        }
+        auto tag = group[order[range.begin]];
+        //two sweeps to a pseudo peripheral vertex
+        Index seed = order[range.begin];
+        for (size_t sweep = 0; sweep < 2; ++sweep) {
+            ++stamp; queue.clear();
+            bfs(seed, tag);
+            seed = queue.back();
+        }
+        ++stamp; queue.clear();
+        bfs(seed, tag);
+        for (auto i = range.begin; i < range.end; ++i) {
+            if (visit[order[i]] != stamp) bfs(order[i], tag);//disconnected components follow
+        }
+        NS_ASSERT(queue.size() == range.end - range.begin);
+        std::copy(queue.begin(), queue.end(), order.begin() + range.begin);
+
+        //cut at the weight ratio, every child keeps at least one vertex per part
+        auto left = range.parts / 2;
+        size_t total{0}, sum{0};
+        for (auto i = range.begin; i < range.end; ++i) total += weights[order[i]];
+        auto mid = range.begin;
+        while (mid < range.end - (range.parts - left) && (mid < range.begin + left || (sum + weights[order[mid]]) * range.parts <= total * left))
+            sum += weights[order[mid++]];
+        Range children[2] = {{range.begin, mid, left, range.first}, {mid, range.end, range.parts - left, range.first + Index(left)}};
+        for (const auto & child : children) {
+            ++groups;
+            for (auto i = child.begin; i < child.end; ++i)
+                group[order[i]] = groups;
+            stack.emplace_back(child);
+        }
+    }
+    return part;
+}
+
+/// part id of each row of symmetric G, rows of a line (starts, ids as in LinearSolver::SetLines) stay in one part,
+/// lines follow the strong vertical coupling of prism columns, so parts are patches of the template triangulation
+template <typename Matrix>
+inline Vec<Index> Partition(const Matrix & G, size_t parts, const Vec<Index> & starts = {}, const Vec<Index> & ids = {})
+{
+    const size_t n = G.rows();
+    //rows of a line contract to one vertex, other rows are vertices of their own
+    Vec<Index> vertex(n, INVALID_INDEX);
+    size_t vertices{0};
+    for (size_t l = 0; l + 1 < starts.size(); ++l, ++vertices) {
+        for (auto k = starts[l]; k < starts[l + 1]; ++k)
+            vertex[ids[k]] = vertices;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (INVALID_INDEX == vertex[i]) vertex[i] = vertices++;
+    }
+    Vec<Index> rows(n), rowStarts(vertices + 1, 0);
+    for (size_t i = 0; i < n; ++i) ++rowStarts[vertex[i] + 1];
+    std::partial_sum(rowStarts.begin(), rowStarts.end(), rowStarts.begin());
+    {
+        auto pos = rowStarts;
+        for (size_t i = 0; i < n; ++i) rows[pos[vertex[i]]++] = i;
+    }
+    Vec<size_t> weights(vertices);
+    Vec<Index> graphStarts(vertices + 1, 0), adjacency;
+    for (size_t v = 0; v < vertices; ++v) {
+        weights[v] = rowStarts[v + 1] - rowStarts[v];
+        auto begin = adjacency.size();
+        for (auto k = rowStarts[v]; k < rowStarts[v + 1]; ++k) {
+            for (typename Matrix::InnerIterator it(G, rows[k]); it; ++it) {
+                if (auto u = vertex[it.row()]; u != Index(v)) adjacency.emplace_back(u);
+            }
+        }
+        std::sort(adjacency.begin() + begin, adjacency.end());
+        adjacency.erase(std::unique(adjacency.begin() + begin, adjacency.end()), adjacency.end());
+        graphStarts[v + 1] = adjacency.size();
+    }
+    auto vertexPart = Bisect(graphStarts, adjacency, weights, parts);
+    Vec<Index> part(n);
+    for (size_t i = 0; i < n; ++i) part[i] = vertexPart[vertex[i]];
+    return part;
+}
+
+} // namespace dd
+} // namespace nano::heat::solver::network
@@ -0,0 +1,405 @@
+#pragma once
+#include "basic/NSHeatAlias.hpp"
+
+#include <Eigen/Sparse>
+namespace nano::heat::solver::network {
+
+/// symmetric successive over-relaxation preconditioner, M = w/(2-w) (D/w + L) (D/w)^-1 (D/w + U)
+template <typename Scalar>
+class SSORPreconditioner
+{
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+public:
+    using StorageIndex = typename Vector::StorageIndex;
+    enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic };
+
+    SSORPreconditioner() = default;
+
+    template <typename MatType>
+    explicit SSORPreconditioner(const MatType & mat) { compute(mat); }
+
+    void setOmega(Scalar omega) { NS_ASSERT(0 < omega && omega < 2); m_omega = omega; }
+
+    Eigen::Index rows() const { return m_A.rows(); }
+    Eigen::Index cols() const { return m_A.cols(); }
+
+    template <typename MatType>
+    SSORPreconditioner & analyzePattern(const MatType &) { return *this; }
+
+    template <typename MatType>
+    SSORPreconditioner & factorize(const MatType & mat)
+    {
+        m_A = mat;
+        m_diag = m_A.diagonal();
+        m_info = (m_diag.array() > 0).all() ? Eigen::Success : Eigen::NumericalIssue;
+        return *this;
+    }
+
+    template <typename MatType>
+    SSORPreconditioner & compute(const MatType & mat) { return factorize(mat); }
+
+    template <typename Rhs, typename Dest>
+    void _solve_impl(const Rhs & b, Dest & x) const
+    {
+        const Eigen::Index n = m_A.rows();
+        const Scalar w = m_omega;
+        x = b;
+        //(D/w + L) y = b
+        for (Eigen::Index i = 0; i < n; ++i) {
+            Scalar s = x[i];
+            for (typename RowMajorMatrix::InnerIterator it(m_A, i); it && it.index() < i; ++it)
+                s -= it.value() * x[it.index()];
+            x[i] = s * w / m_diag[i];
+        }
+        //z = (2-w)/w (D/w) y
+        for (Eigen::Index i = 0; i < n; ++i)
+            x[i] *= (2 - w) / w * m_diag[i] / w;
+        //(D/w + U) x = z
+        for (Eigen::Index i = n - 1; i >= 0; --i) {
+            Scalar s = x[i];
+            typename RowMajorMatrix::InnerIterator it(m_A, i);
+            while (it && it.index() <= i) ++it;
+            for (; it; ++it) s -= it.value() * x[it.index()];
+            x[i] = s * w / m_diag[i];
+        }
+    }
+
+    template <typename Rhs>
+    inline const Eigen::Solve<SSORPreconditioner, Rhs> solve(const Eigen::MatrixBase<Rhs> & b) const
+    {
+        return Eigen::Solve<SSORPreconditioner, Rhs>(*this, b.derived());
+    }
+
+    Eigen::ComputationInfo info() const { return m_info; }
+
+private:
+    using RowMajorMatrix = Eigen::SparseMatrix<Scalar, Eigen::RowMajor>;
+    Scalar m_omega{1};
+    Vector m_diag;
+    RowMajorMatrix m_A;
+    Eigen::ComputationInfo m_info{Eigen::Success};
+};
+
+/// line jacobi, each line (e.g. a vertical prism column) is solved exactly by the thomas algorithm
+/// rows not covered by any line fall back to point jacobi, lines are independent and processed in parallel
+template <typename Scalar>
+class LinePreconditioner
+{
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+public:
+    using StorageIndex = typename Vector::StorageIndex;
+    enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic };
+
+    LinePreconditioner() = default;
+
+    template <typename MatType>
+    explicit LinePreconditioner(const MatType & mat) { compute(mat); }
+
+    /// lines in matrix order, line i is ids[starts[i]:starts[i+1]], consecutive ids are coupled
+    void setLines(Vec<Index> starts, Vec<Index> ids)
+    {
+        m_starts = std::move(starts);
+        m_ids = std::move(ids);
+    }
+
+    Eigen::Index rows() const { return m_size; }
+    Eigen::Index cols() const { return m_size; }
+    size_t lines() const { return m_starts.empty() ? 0 : m_starts.size() - 1; }
+
+    template <typename MatType>
+    LinePreconditioner & analyzePattern(const MatType & mat)
+    {
+        m_size = mat.rows();
+        if (m_starts.empty()) m_starts.assign(1, 0);
+        m_points.clear();
+        Vec<bool> covered(m_size, false);
+        for (auto id : m_ids) {
+            NS_ASSERT(Eigen::Index(id) < m_size && not covered[id]);
+            covered[id] = true;
+        }
+        for (Eigen::Index i = 0; i < m_size; ++i)
+            if (not covered[i]) m_points.emplace_back(i);
+        m_lower.resize(m_ids.size());
+        m_inv.resize(m_ids.size());
+        m_pointInv.resize(m_points.size());
+        return *this;
+    }
+
+    template <typename MatType>
+    LinePreconditioner & factorize(const MatType & mat)
+    {
+        NS_ASSERT(mat.rows() == m_size);
+        bool success{true};
+        const Eigen::Index lines = this->lines();
+        #pragma omp parallel for schedule(dynamic, 64) reduction(&&:success)
+        for (Eigen::Index l = 0; l < lines; ++l) {
+            //symmetric tridiagonal LDL^T, m_lower[k] = a(k, k-1) / d(k-1), m_inv[k] = 1 / d(k)
+            Scalar d = 0;
+            for (auto k = m_starts[l]; k < m_starts[l + 1]; ++k) {
+                auto a = mat.coeff(m_ids[k], m_ids[k]);
+                m_lower[k] = 0;
+                if (k > m_starts[l]) {
+                    auto e = mat.coeff(m_ids[k], m_ids[k - 1]);
+                    m_lower[k] = e / d;
+                    a -= m_lower[k] * e;
+                }
+                success = success && a > 0;
+                d = a;
+                m_inv[k] = 1 / d;
+            }
+        }
+        for (size_t p = 0; p < m_points.size(); ++p) {
+            auto a = mat.coeff(m_points[p], m_points[p]);
+            m_pointInv[p] = a != 0 ? 1 / a : 1;
+        }
+        m_info = success ? Eigen::Success : Eigen::NumericalIssue;
+        return *this;
+    }
+
+    template <typename MatType>
+    LinePreconditioner & compute(const MatType & mat)
+    {
+        analyzePattern(mat);
+        return factorize(mat);
+    }
+
+    template <typename Rhs, typename Dest>
+    void _solve_impl(const Rhs & b, Dest & x) const
+    {
+        x.resize(m_size);
+        const Eigen::Index lines = this->lines();
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (Eigen::Index l = 0; l < lines; ++l) {
+            auto begin = m_starts[l], end = m_starts[l + 1];
+            //L y = b
+            Scalar y = 0;
+            for (auto k = begin; k < end; ++k) {
+                y = b[m_ids[k]] - m_lower[k] * y;
+                x[m_ids[k]] = y;
+            }
+            //D L^T x = y
+            Scalar next = 0;
+            for (auto k = end; k-- > begin;) {
+                next = x[m_ids[k]] * m_inv[k] - (k + 1 < end ? m_lower[k + 1] * next : 0);
+                x[m_ids[k]] = next;
+            }
+        }
+        for (size_t p = 0; p < m_points.size(); ++p)
+            x[m_points[p]] = b[m_points[p]] * m_pointInv[p];
+    }
+
+    template <typename Rhs>
+    inline const Eigen::Solve<LinePreconditioner, Rhs> solve(const Eigen::MatrixBase<Rhs> & b) const
+    {
+        return Eigen::Solve<LinePreconditioner, Rhs>(*this, b.derived());
+    }
+
+    Eigen::ComputationInfo info() const { return m_info; }
+
+private:
+    Eigen::Index m_size{0};
+    Vec<Index> m_starts;
+    Vec<Index> m_ids;
+    Vec<Index> m_points;
+    Vec<Scalar> m_lower;
+    Vec<Scalar> m_inv;
+    Vec<Scalar> m_pointInv;
+    Eigen::ComputationInfo m_info{Eigen::Success};
+};
+
+/// level of fill incomplete cholesky on diagonal scaled matrix, S G S ~ U^T U
+/// the symbolic pattern is computed in analyzePattern() and reused by every factorize()
+template <typename Scalar>
+class IncompleteCholeskyPreconditioner
+{
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+public:
+    using StorageIndex = typename Vector::StorageIndex;
+    enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic };
+
+    IncompleteCholeskyPreconditioner() = default;
+
+    template <typename MatType>
+    explicit IncompleteCholeskyPreconditioner(const MatType & mat) { compute(mat); }
+
+    void setFillLevel(size_t level) { m_level = level; }
+    void setInitialShift(Scalar shift) { m_shift = shift; }
+
+    Eigen::Index rows() const { return m_size; }
+    Eigen::Index cols() const { return m_size; }
+
+    /// builds row pattern of U with level of fill no greater than m_level
+    template <typename MatType>
+    IncompleteCholeskyPreconditioner & analyzePattern(const MatType & mat)
+    {
+        const Eigen::Index n = mat.cols();
+        m_size = n;
+        m_rowPtr.assign(1, 0);
+        m_colIdx.clear();
+        Vec<size_t> levels;
+        Vec<Eigen::Index> head(n, -1), next(n, -1), cur(n, 0);
+        Vec<size_t> mark(n, NONE);
+        Vec<Eigen::Index> cols;
+        for (Eigen::Index i = 0; i < n; ++i) {
+            cols.clear();
+            cols.emplace_back(i); mark[i] = 0;
+            for (typename MatType::InnerIterator it(mat, i); it; ++it) {
+                if (it.index() <= i) continue;
+                cols.emplace_back(it.index());
+                mark[it.index()] = 0;
+            }
+            for (auto k = head[i]; k != -1;) {
+                auto nk = next[k];
+                auto p = cur[k];
+                auto levKI = levels[p];
+                for (auto q = p + 1; q < Eigen::Index(m_rowPtr[k + 1]); ++q) {
+                    auto lev = levKI + levels[q] + 1;
+                    if (lev > m_level) continue;
+                    auto j = m_colIdx[q];
+                    if (NONE == mark[j]) {
+                        mark[j] = lev;
+                        cols.emplace_back(j);
+                    }
+                    else mark[j] = std::min(mark[j], lev);
+                }
+                Link(k, p + 1, head, next, cur);
+                k = nk;
+            }
+            std::sort(cols.begin(), cols.end());
+            for (auto j : cols) {
+                m_colIdx.emplace_back(j);
+                levels.emplace_back(mark[j]);
+                mark[j] = NONE;
+            }
+            m_rowPtr.emplace_back(m_colIdx.size());
+            Link(i, m_rowPtr[i] + 1, head, next, cur);
+        }
+        m_values.resize(m_colIdx.size());
+        m_analyzed = true;
+        return *this;
+    }
+
+    template <typename MatType>
+    IncompleteCholeskyPreconditioner & factorize(const MatType & mat)
+    {
+        NS_ASSERT(m_analyzed && mat.cols() == m_size);
+        const Eigen::Index n = m_size;
+        m_scale.resize(n);
+        for (Eigen::Index i = 0; i < n; ++i) {
+            auto d = std::abs(mat.coeff(i, i));
+            m_scale[i] = d > 0 ? 1 / std::sqrt(d) : 1;
+        }
+
+        Scalar shift = 0;
+        for (size_t retry = 0; retry < MAX_RETRY; ++retry) {
+            if (NumericFactorize(mat, shift)) {
+                m_info = Eigen::Success;
+                return *this;
+            }
+            shift = std::max<Scalar>(m_shift, 2 * shift);
+        }
+        m_info = Eigen::NumericalIssue;
+        return *this;
+    }
+
+    template <typename MatType>
+    IncompleteCholeskyPreconditioner & compute(const MatType & mat)
+    {
+        analyzePattern(mat);
+        return factorize(mat);
+    }
+
+    template <typename Rhs, typename Dest>
+    void _solve_impl(const Rhs & b, Dest & x) const
+    {
+        const Eigen::Index n = m_size;
+        x = m_scale.cwiseProduct(b);
+        //U^T z = S b
+        for (Eigen::Index i = 0; i < n; ++i) {
+            x[i] /= m_values[m_rowPtr[i]];
+            for (auto p = m_rowPtr[i] + 1; p < m_rowPtr[i + 1]; ++p)
+                x[m_colIdx[p]] -= m_values[p] * x[i];
+        }
+        //U y = z
+        for (Eigen::Index i = n - 1; i >= 0; --i) {
+            Scalar s = x[i];
+            for (auto p = m_rowPtr[i] + 1; p < m_rowPtr[i + 1]; ++p)
+                s -= m_values[p] * x[m_colIdx[p]];
+            x[i] = s / m_values[m_rowPtr[i]];
+        }
+        x = m_scale.cwiseProduct(x);
+    }
+
+    template <typename Rhs>
+    inline const Eigen::Solve<IncompleteCholeskyPreconditioner, Rhs> solve(const Eigen::MatrixBase<Rhs> & b) const
+    {
+        return Eigen::Solve<IncompleteCholeskyPreconditioner, Rhs>(*this, b.derived());
+    }
+
+    Eigen::ComputationInfo info() const { return m_info; }
+    size_t nonZeros() const { return m_colIdx.size(); }
+
+private:
+    /// attach row k to the list of its next column at position p
+    void Link(Eigen::Index k, Eigen::Index p, Vec<Eigen::Index> & head, Vec<Eigen::Index> & next, Vec<Eigen::Index> & cur) const
+    {
+        cur[k] = p;
+        if (p >= Eigen::Index(m_rowPtr[k + 1])) return;
+        auto j = m_colIdx[p];
+        next[k] = head[j];
+        head[j] = k;
+    }
+
+    template <typename MatType>
+    bool NumericFactorize(const MatType & mat, Scalar shift)
+    {
+        const Eigen::Index n = m_size;
+        Vec<Eigen::Index> head(n, -1), next(n, -1), cur(n, 0);
+        Vec<Eigen::Index> mark(n, -1);
+        Vector w = Vector::Zero(n);
+        for (Eigen::Index i = 0; i < n; ++i) {
+            for (auto p = m_rowPtr[i]; p < m_rowPtr[i + 1]; ++p)
+                mark[m_colIdx[p]] = i;
+            for (typename MatType::InnerIterator it(mat, i); it; ++it) {
+                if (it.index() < i) continue;
+                w[it.index()] = it.value() * m_scale[i] * m_scale[it.index()];
+            }
+            w[i] += shift;
+            for (auto k = head[i]; k != -1;) {
+                auto nk = next[k];
+                auto p = cur[k];
+                auto uKI = m_values[p];
+                for (auto q = p; q < Eigen::Index(m_rowPtr[k + 1]); ++q) {
+                    auto j = m_colIdx[q];
+                    if (mark[j] == i) w[j] -= uKI * m_values[q];
+                }
+                Link(k, p + 1, head, next, cur);
+                k = nk;
+            }
+            if (not (w[i] > 0)) return false;
+            auto d = std::sqrt(w[i]);
+            m_values[m_rowPtr[i]] = d; w[i] = 0;
+            for (auto p = m_rowPtr[i] + 1; p < m_rowPtr[i + 1]; ++p) {
+                m_values[p] = w[m_colIdx[p]] / d;
+                w[m_colIdx[p]] = 0;
+            }
+            Link(i, m_rowPtr[i] + 1, head, next, cur);
+        }
+        return true;
+    }
+
+private:
+    inline static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+    inline static constexpr size_t MAX_RETRY = 10;
+    size_t m_level{0};
+    Scalar m_shift{1e-3};
+    Eigen::Index m_size{0};
+    bool m_analyzed{false};
+    Vec<size_t> m_rowPtr;
+    Vec<StorageIndex> m_colIdx;//row pattern of U, diagonal first
+    Vec<Scalar> m_values;
+    Vector m_scale;
+    Eigen::ComputationInfo m_info{Eigen::Success};
+};
+
+} // namespace nano::heat::solver::network
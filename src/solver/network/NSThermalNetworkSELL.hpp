@@ -0,0 +1,123 @@
+#pragma once
+#include "basic/NSHeatAlias.hpp"
+
+#include <Eigen/Sparse>
+#include <numeric>
+namespace nano::heat::solver::network {
+
+/// sliced ELLPACK (SELL-C-sigma) copy of a symmetric sparse matrix for vectorized y = A x,
+/// rows are sorted by length inside windows of sigma rows and packed into slices of C rows, each slice is padded to its longest row
+/// and stored lane fastest, so the inner loop over the C lanes is a unit stride SIMD loop, slices run in parallel
+template <typename Scalar, size_t C = 8>
+class SellMatrix
+{
+public:
+    using Matrix = Eigen::SparseMatrix<Scalar>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+    inline static constexpr size_t SLICE_HEIGHT = C;
+
+    Eigen::Index rows() const { return m_rows; }
+    size_t NonZeros() const { return m_nnz; }
+    /// stored entries including padding
+    size_t Storage() const { return m_values.size(); }
+
+    /// builds the slice layout of G, G is symmetric so its columns are used as rows, sigma is rounded up to a multiple of C
+    void Analyze(const Matrix & G, size_t sigma)
+    {
+        NS_ASSERT(G.rows() == G.cols());
+        m_rows = G.rows();
+        m_nnz = G.nonZeros();
+        sigma = std::max<size_t>(1, (sigma + C - 1) / C) * C;
+        const size_t slices = (m_rows + C - 1) / C;
+        auto outer = G.outerIndexPtr();
+        auto length = [&](Index row) { return Index(outer[row + 1] - outer[row]); };
+
+        m_perm.resize(slices * C);
+        std::iota(m_perm.begin(), m_perm.begin() + m_rows, 0);
+        std::fill(m_perm.begin() + m_rows, m_perm.end(), INVALID_INDEX);
+        for (size_t begin = 0; begin < size_t(m_rows); begin += sigma) {
+            auto end = std::min(begin + sigma, size_t(m_rows));
+            std::stable_sort(m_perm.begin() + begin, m_perm.begin() + end, [&](Index a, Index b) { return length(a) > length(b); });
+        }
+        m_starts.assign(slices + 1, 0);
+        m_widths.assign(slices, 0);
+        for (size_t s = 0; s < slices; ++s) {
+            for (size_t lane = 0; lane < C; ++lane) {
+                if (auto row = m_perm[s * C + lane]; INVALID_INDEX != row)
+                    m_widths[s] = std::max<Index>(m_widths[s], length(row));
+            }
+            m_starts[s + 1] = m_starts[s] + m_widths[s] * C;
+        }
+        //padding points to the row itself with zero value, no branch in the kernel
+        m_columns.resize(m_starts.back());
+        m_values.assign(m_starts.back(), 0);
+        m_slots.resize(m_nnz);
+        #pragma omp parallel for schedule(static)
+        for (size_t s = 0; s < slices; ++s) {
+            for (size_t lane = 0; lane < C; ++lane) {
+                auto row = m_perm[s * C + lane];
+                auto self = INVALID_INDEX == row ? 0 : row;
+                for (Index k = 0; k < m_widths[s]; ++k) {
+                    auto pos = m_starts[s] + k * C + lane;
+                    if (INVALID_INDEX == row || k >= length(row)) {
+                        m_columns[pos] = self;
+                        continue;
+                    }
+                    m_columns[pos] = G.innerIndexPtr()[outer[row] + k];
+                    m_slots[outer[row] + k] = pos;
+                }
+            }
+        }
+        Fill(G);
+    }
+
+    /// copies the values of G with the analyzed pattern
+    void Fill(const Matrix & G)
+    {
+        NS_ASSERT(size_t(G.nonZeros()) == m_nnz);
+        auto values = G.valuePtr();
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < m_nnz; ++i)
+            m_values[m_slots[i]] = values[i];
+    }
+
+    /// y = A x, returns x . y when dot is true, the dot product of the CG step is fused into the sweep
+    Scalar Multiply(const Vector & x, Vector & y, bool dot = false) const
+    {
+        y.resize(m_rows);
+        const Index slices = m_widths.size();
+        const auto * xs = x.data();
+        auto * ys = y.data();
+        Scalar sum = 0;
+        #pragma omp parallel for schedule(static) reduction(+:sum)
+        for (Index s = 0; s < slices; ++s) {
+            Scalar acc[C] = {};
+            const auto * columns = m_columns.data() + m_starts[s];
+            const auto * values = m_values.data() + m_starts[s];
+            for (Index k = 0; k < m_widths[s]; ++k, columns += C, values += C) {
+                #pragma omp simd
+                for (size_t lane = 0; lane < C; ++lane)
+                    acc[lane] += values[lane] * xs[columns[lane]];
+            }
+            const auto * rows = m_perm.data() + s * C;
+            for (size_t lane = 0; lane < C; ++lane) {
+                if (INVALID_INDEX == rows[lane]) continue;
+                ys[rows[lane]] = acc[lane];
+                if (dot) sum += acc[lane] * xs[rows[lane]];
+            }
+        }
+        return sum;
+    }
+
+private:
+    Eigen::Index m_rows{0};
+    size_t m_nnz{0};
+    Vec<Index> m_perm;//row of each slice lane, INVALID_INDEX for padding lanes
+    Vec<Index> m_starts;//offset of each slice
+    Vec<Index> m_widths;//padded row length of each slice
+    Vec<int> m_columns;
+    Vec<Scalar> m_values;
+    Vec<Index> m_slots;//SELL position of each nonzero of G
+};
+
+} // namespace nano::heat::solver::network
@@ -1,5 +1,8 @@
 #pragma once
 #include "NSThermalNetwork.hpp"
+#include "NSThermalNetworkCondensation.hpp"
+#include "NSThermalNetworkLinearSolver.hpp"
+#include "NSThermalNetworkOperator.hpp"
 #include "generic/tools/Tools.hpp"
 #include "generic/circuit/MNA.hpp"
 #include "generic/circuit/MOR.hpp"
@@ -18,38 +21,426 @@ template <typename Scalar>
 class ThermalNetworkStaticSolver
 {
 public:
+    using Matrix = SparseMatrix<Scalar>;
     generic::math::la::DenseVector<Scalar> x;
-    void Solve(CRef<ThermalNetwork<Scalar>> network, Scalar refT, Vec<Scalar> & result)
+    explicit ThermalNetworkStaticSolver(CRef<ThermalNetworkLinearSolverSettings> settings = {})
+     : m_matrixFree(settings.matrixFree)
+    {
+        if (m_matrixFree) {
+            if (settings.mixedPrecision) NS_TRACE("matrix free solver has no factorization to lower, mixed precision is ignored");
+            auto solver = std::make_unique<MatrixFreeSolver<Scalar>>(settings);
+            m_op = &solver->GetOperator();
+            m_solver = std::move(solver);
+        }
+        else m_solver = CreateLinearSolver<Scalar>(settings);
+        m_last = m_solver.get();
+    }
+
+    /// summary of the last linear solve, newton corrections report their LU solve
+    CRef<LinearSolveSummary> Summary() const { return m_last->summary; }
+
+    void SetTolerance(Scalar tolerance) { m_solver->SetTolerance(tolerance); }
+
+    /// static solves on the network with series node chains condensed, e.g. bonding wire segments,
+    /// chain interior temperatures are back substituted into the result
+    void SetCondensation(bool condense)
+    {
+        if (not condense) m_condensation.reset();
+        else if (not m_condensation) m_condensation = std::make_unique<ChainCondensation<Scalar>>();
+    }
+
+    /// guess: temperatures in node order used as initial guess of iterative solvers, e.g. the previous P-T iterate
+    void Solve(CRef<ThermalNetwork<Scalar>> network, Scalar refT, Vec<Scalar> & result, CPtr<Vec<Scalar>> guess = nullptr)
+    {
+        if (m_condensation) {
+            if (not m_condensation->isValid(network)) m_condensation->Analyze(network);
+            if (m_condensation->ChainSize() > 0) {
+                auto reduced = m_condensation->Condense(network);
+                Vec<Scalar> reducedT, reducedGuess;
+                if (guess) reducedGuess = m_condensation->Restrict(*guess);
+                SolveNetwork(*reduced, refT, reducedT, guess ? &reducedGuess : nullptr);
+                m_condensation->Expand(network, reducedT, result);
+                return;
+            }
+        }
+        SolveNetwork(network, refT, result, guess);
+    }
+
+    /// batched solve of many power maps against one G, hf replaces the node heat flows column by column (node order),
+    /// results holds the temperatures of each column in node order
+    void Solve(CRef<ThermalNetwork<Scalar>> network, Scalar refT, const DenseMatrix<Scalar> & hf, DenseMatrix<Scalar> & results)
+    {
+        NS_ASSERT(size_t(hf.rows()) == network.NodeSize());
+        Fill(network);
+        m_solver->Factorize(m_G);
+        DenseMatrix<Scalar> B(network.MatrixSize(), hf.cols()), X;
+        for (size_t mid = 0; mid < network.MatrixSize(); ++mid) {
+            auto nid = network.NodeId(mid);
+            auto fixed = makeSourceRhs(network, nid, refT) - network[nid].hf;
+            B.row(mid) = hf.row(nid).array() + fixed;
+        }
+        m_solver->Solve(B, X);
+        NS_TRACE("batched linear solve of %1% power maps, iterations: %2%, residual: %3%", hf.cols(), Summary().iterations, Summary().residual);
+        if (not Summary().converged) NS_TRACE("linear solver not converged");
+        results.resize(network.NodeSize(), hf.cols());
+        for (size_t i = 0; i < network.NodeSize(); ++i) {
+            if (auto t = network[i].t; ThermalNetwork<Scalar>::UNKNOWN_T != t)
+                results.row(i).setConstant(t);
+        }
+        for (size_t mid = 0; mid < network.MatrixSize(); ++mid)
+            results.row(network.NodeId(mid)) = X.row(mid);
+    }
+
+    /// adjoint solves G^T Y = L^T, one column per probe (node index), G is symmetric so G^T = G,
+    /// transfer(p, s) is the temperature rise at probe p per watt injected at source s in Sources() order, unit: K/W
+    /// Y holds the adjoint fields in matrix order, Y^T h gives the probe response of any matrix order heat flow h
+    void SolveAdjoint(CRef<ThermalNetwork<Scalar>> network, const Vec<Index> & probes, DenseMatrix<Scalar> & transfer, DenseMatrix<Scalar> & Y)
+    {
+        Fill(network);
+        m_solver->Factorize(m_G);
+        DenseMatrix<Scalar> L = DenseMatrix<Scalar>::Zero(network.MatrixSize(), probes.size());
+        for (size_t p = 0; p < probes.size(); ++p) {
+            if (network[probes[p]].t == network.UNKNOWN_T)
+                L(network.MatrixId(probes[p]), p) = 1;
+        }
+        m_solver->Solve(L, Y);
+        NS_TRACE("adjoint solve of %1% probes, iterations: %2%, residual: %3%", probes.size(), Summary().iterations, Summary().residual);
+        if (not Summary().converged) NS_TRACE("linear solver not converged");
+        const auto & sources = network.Sources();
+        transfer.resize(probes.size(), sources.size());
+        for (size_t s = 0; s < sources.size(); ++s)
+            transfer.col(s) = Y.row(network.MatrixId(sources[s])).transpose();
+    }
+
+    void SolveAdjoint(CRef<ThermalNetwork<Scalar>> network, const Vec<Index> & probes, DenseMatrix<Scalar> & transfer)
+    {
+        DenseMatrix<Scalar> Y;
+        SolveAdjoint(network, probes, transfer, Y);
+    }
+
+    /// newton correction J dT = -F(T), T in node order, dT is zero on fixed temperature nodes,
+    /// J is the full jacobian of makeResidual() from the slopes the builder put into the network in the same build,
+    /// including the off diagonal conductance derivative terms, so it is not symmetric and is solved by sparse LU,
+    /// the configured linear solver is not used, a network without slopes gives the picard matrix
+    void SolveNewton(CRef<ThermalNetwork<Scalar>> network, Scalar refT, const Vec<Scalar> & T, Vec<Scalar> & dT)
+    {
+        if (nullptr == m_lu) m_lu = std::make_unique<SparseLUSolver<Scalar>>();
+        m_last = m_lu.get();
+        x.resize(network.MatrixSize());
+        if (not m_jacobianPattern.isValid(network)) {
+            m_jacobianPattern.Analyze(network, m_J);
+            m_lu->Analyze(m_J);
+        }
+        m_jacobianPattern.FillJacobian(network, T, MIN_JACOBIAN_DIAG_RATIO, m_J);
+        m_lu->Factorize(m_J);
+
+        DenseVector<Scalar> rhs = -makeResidual(network, refT, T);
+        m_lu->Solve(rhs, x, false);
+        NS_TRACE("newton linear solve residual: %1%", Summary().residual);
+        if (not Summary().converged) NS_TRACE("linear solver not converged");
+        dT.assign(network.NodeSize(), 0);
+        for (size_t i = 0; i < size_t(x.size()); ++i)
+            dT[network.NodeId(i)] = x[i];
+    }
+
+private:
+    void SolveNetwork(CRef<ThermalNetwork<Scalar>> network, Scalar refT, Vec<Scalar> & result, CPtr<Vec<Scalar>> guess)
     {
         x.resize(network.MatrixSize());
         result.resize(network.NodeSize());
-        auto m = makeMNA(network);
-        auto rhs = makeRhs(network, refT);
+        Fill(network);
+        m_solver->Factorize(m_G);
+        auto rhs = makeMatrixRhs(network, refT);
         for (size_t i = 0; i < network.NodeSize(); ++i) {
             auto & node = network[i];
-            if (ThermalNetwork<Scalar>::UNKNOWN_T == node.t) {
-                // x[network.MatrixId(i)] = result[i];
-                continue;
-            }
-            else result[i] = node.t;
+            if (ThermalNetwork<Scalar>::UNKNOWN_T != node.t)
+                result[i] = node.t;
+        }
+        if (guess) {
+            NS_ASSERT(guess->size() == network.NodeSize());
+            for (size_t i = 0; i < size_t(x.size()); ++i)
+                x[i] = guess->at(network.NodeId(i));
         }
-        Eigen::ConjugateGradient<SparseMatrix<Scalar>, Eigen::Lower|Eigen::Upper> solver(m.G);
-        // x = m.L * solver.solveWithGuess(m.B * rhs, x);
-        x = m.L * solver.solve(m.B * rhs);
-        NS_TRACE("Eigen CG iterations: %1%", solver.iterations());
-        NS_TRACE("Eigen CG error: %1%", solver.error());
+        m_solver->Solve(rhs, x, nullptr != guess);
+        NS_TRACE("linear solver iterations: %1%, residual: %2%", Summary().iterations, Summary().residual);
+        if (not Summary().converged) NS_TRACE("linear solver not converged");
         for (size_t i = 0; i < size_t(x.size()); ++i) {
             auto nid = network.NodeId(i);
             result[nid] = x[i];
         }
     }
+
+    /// analyze matrix pattern on topology change and refill G, the matrix free operator only attaches the network
+    void Fill(CRef<ThermalNetwork<Scalar>> network)
+    {
+        m_last = m_solver.get();
+        if (m_matrixFree) {
+            m_op->Attach(network);
+            if (m_topology != network.Topology()) {
+                m_topology = network.Topology();
+                Vec<Index> starts, ids;
+                makeMatrixColumns(network, starts, ids);
+                m_solver->SetLines(std::move(starts), std::move(ids));
+                m_solver->Analyze(m_G);
+            }
+            return;
+        }
+        if (not m_pattern.isValid(network)) {
+            m_pattern.Analyze(network, m_G);
+            Vec<Index> starts, ids;
+            makeMatrixColumns(network, starts, ids);
+            m_solver->SetLines(std::move(starts), std::move(ids));
+            m_solver->Analyze(m_G);
+            NS_TRACE("analyze conductance matrix pattern, nnz: %1%", m_G.nonZeros());
+        }
+        m_pattern.Fill(network, m_G);
+    }
+
+    /// lower bound of the jacobian diagonal relative to the diagonal of G, keeps J nonsingular under steep power
+    inline static constexpr Scalar MIN_JACOBIAN_DIAG_RATIO = 0.5;
+    bool m_matrixFree{false};
+    size_t m_topology{0};
+    Matrix m_G;//empty in matrix free mode
+    Ptr<ThermalNetworkOperator<Scalar>> m_op{nullptr};//owned by the matrix free solver
+    ConductancePattern<Scalar> m_pattern;
+    UPtr<LinearSolver<Scalar>> m_solver;
+    UPtr<ChainCondensation<Scalar>> m_condensation;
+    ConductancePattern<Scalar> m_jacobianPattern;
+    Matrix m_J;//newton jacobian
+    UPtr<SparseLUSolver<Scalar>> m_lu;//created by the first newton solve
+    CPtr<LinearSolver<Scalar>> m_last{nullptr};//solver of the last solve, owned by m_solver or m_lu
 };
 
+/// implicit time stepping of C dT/dt + G T = q(t), every implicit solve is on A = C / h + G,
+/// theta scheme with h = theta dt: backward euler theta = 1, crank nicolson theta = 1/2,
+/// TR-BDF2 with gamma = 2 - sqrt(2): the trapezoidal and the BDF2 stage share h = (1 - sqrt(2) / 2) dt,
+/// A is factorized (or its preconditioner built) once per distinct h,
+/// the scenario power of each node is scaled by excitation(t, scenario), other heat flow (e.g. boundary heat flux) is constant
+template <typename Scalar>
+class ThermalNetworkTransientSolver
+{
+public:
+    using Matrix = SparseMatrix<Scalar>;
+    using Vector = DenseVector<Scalar>;
+    using Method = ThermalNetworkTransientSolverSettings::Method;
+    explicit ThermalNetworkTransientSolver(CRef<ThermalNetworkTransientSolverSettings> settings)
+     : m_settings(settings)
+    {
+        if (settings.linearSettings.matrixFree) NS_TRACE("transient solver assembles G, matrix free mode is ignored");
+        m_solver = CreateLinearSolver<Scalar>(settings.linearSettings);
+    }
+
+    CRef<LinearSolveSummary> Summary() const { return m_solver->summary; }
+    /// all linear solves of the last Step() or Advance(), rejected TR-BDF2 attempts included,
+    /// iterations are summed and the residual is the worst
+    CRef<LinearSolveSummary> StepSummary() const { return m_step; }
+    size_t Factorizations() const { return m_factorizations; }
+    /// TR-BDF2 steps rejected by the local error test
+    size_t Rejections() const { return m_rejections; }
+    Scalar Time() const { return m_time; }
+    /// temperatures of the unknown nodes in matrix order
+    const Vector & State() const { return m_x; }
 
+    /// state at time 0 from T in node order, network must outlive the solver
+    void Initialize(CRef<ThermalNetwork<Scalar>> network, Scalar refT, const Vec<Scalar> & T, CRef<ThermalTransientExcitation> excitation)
+    {
+        NS_ASSERT(T.size() == network.NodeSize());
+        m_network = &network;
+        m_excitation = excitation;
+        m_pattern.Analyze(network, m_G);
+        m_pattern.Fill(network, m_G);
+        m_A = m_G;
+        Vec<Index> starts, ids;
+        makeMatrixColumns(network, starts, ids);
+        m_solver->SetLines(std::move(starts), std::move(ids));
+        m_solver->Analyze(m_A);
 
+        const size_t ms = network.MatrixSize();
+        m_c.resize(ms);
+        m_x.resize(ms);
+        m_power.resize(ms);
+        m_fixed.resize(ms);
+        m_scenarios.clear();
+        m_rows.assign(ms, INVALID_INDEX);
+        HashMap<Index, Index> scenarios;
+        for (size_t mid = 0; mid < ms; ++mid) {
+            auto nid = network.NodeId(mid);
+            const auto & node = network[nid];
+            m_c[mid] = node.c;
+            m_x[mid] = T[nid];
+            m_power[mid] = node.power;
+            m_fixed[mid] = makeSourceRhs(network, nid, refT) - node.power;
+            if (0 == node.power || INVALID_INDEX == node.scen) continue;
+            auto [iter, added] = scenarios.emplace(node.scen, m_scenarios.size());
+            if (added) m_scenarios.emplace_back(node.scen);
+            m_rows[mid] = iter->second;
+        }
+        m_ratios.resize(m_scenarios.size());
+        m_time = 0;
+        m_h = 0;
+        m_factorizations = 0;
+        m_rejections = 0;
+        Load(m_time, m_q);
+    }
 
+    /// advances the state by dt with the theta scheme, x is the initial guess of iterative solvers,
+    /// dt within round off of the factorized step reuses the factorization
+    bool Step(Scalar dt)
+    {
+        NS_ASSERT(m_network && dt > 0 && Method::TR_BDF2 != m_settings.method);
+        const Scalar theta = Method::BACKWARD_EULER == m_settings.method ? 1 : 0.5;
+        auto h = Factorize(theta * dt);
+        dt = h / theta;
+        Load(m_time + dt, m_q1);
+        //(C / dt + theta G) x1 = C / dt x0 + theta q1 + (1 - theta) (q0 - G x0), divided by theta
+        Vector rhs = m_c.cwiseProduct(m_x) / h + m_q1;
+        if (theta < 1) rhs += (1 - theta) / theta * (m_q - m_G * m_x);
+        m_solver->Solve(rhs, m_x, true);
+        m_step = Summary();
+        std::swap(m_q, m_q1);
+        m_time += dt;
+        return Summary().converged;
+    }
 
+    /// one TR-BDF2 step of at most dt, rejected steps are retried with a smaller step until the local truncation error
+    /// is below settings.tolerance or the step reaches settings.minStep, returns the step taken,
+    /// next is the proposed following step, it keeps dt unless the error asks for a change beyond settings.stepChangeRatio
+    Scalar Advance(Scalar dt, Scalar & next)
+    {
+        NS_ASSERT(m_network && dt > 0 && Method::TR_BDF2 == m_settings.method);
+        const Scalar minStep = std::min<Scalar>(m_settings.minStep, dt);
+        Vector x0 = m_x, xg, rhs, f0, fg, f1;
+        Derivative(m_x, m_q, f0);
+        m_step = LinearSolveSummary{0, 0, true};
+        for (;;) {
+            dt = Factorize(TR_BDF2_W * dt) / TR_BDF2_W;
+            auto h = TR_BDF2_W * dt;
+            //trapezoidal stage to t + gamma dt
+            Load(m_time + TR_BDF2_GAMMA * dt, m_q1);
+            xg = x0;
+            rhs = m_c.cwiseProduct(x0) / h + m_q + m_q1 - m_G * x0;
+            bool converged = m_solver->Solve(rhs, xg, true);
+            Accumulate();
+            Derivative(xg, m_q1, fg);
+            //BDF2 stage to t + dt
+            Load(m_time + dt, m_q1);
+            m_x = xg;
+            rhs = m_c.cwiseProduct(TR_BDF2_A * xg - TR_BDF2_B * x0) / h + m_q1;
+            converged = m_solver->Solve(rhs, m_x, true) && converged;
+            Accumulate();
+            if (not converged) NS_TRACE("linear solver not converged at %1%s", m_time + dt);
+            Derivative(m_x, m_q1, f1);
 
+            //LTE = 2 k dt (-f0 / gamma + fg / (gamma (1 - gamma)) - f1 / (1 - gamma)), rows without capacitance are algebraic
+            Scalar error = 0;
+            for (Eigen::Index i = 0; i < m_x.size(); ++i) {
+                auto lte = -f0[i] / TR_BDF2_GAMMA + fg[i] / (TR_BDF2_GAMMA * (1 - TR_BDF2_GAMMA)) - f1[i] / (1 - TR_BDF2_GAMMA);
+                error = std::max(error, std::fabs(2 * TR_BDF2_K * dt * lte));
+            }
+            auto ratio = error / m_settings.tolerance;
+            auto factor = ratio > 0 ? SAFETY * std::pow(ratio, Scalar(-1) / 3) : MAX_STEP_GROWTH;
+            if (ratio <= 1 || dt <= minStep) {
+                if (ratio > 1) NS_TRACE("local truncation error %1%K above tolerance at minimum step %2%s", error, dt);
+                std::swap(m_q, m_q1);
+                m_time += dt;
+                next = dt * std::min(factor, MAX_STEP_GROWTH);
+                if (next < dt * m_settings.stepChangeRatio && next * m_settings.stepChangeRatio > dt) next = dt;
+                if (m_settings.maxStep > 0) next = std::min<Scalar>(next, m_settings.maxStep);
+                return dt;
+            }
+            ++m_rejections;
+            m_x = x0;
+            dt = std::max(minStep, dt * std::max(factor, MIN_STEP_SHRINK));
+        }
+    }
 
+    /// temperatures in node order, fixed temperature nodes keep their value
+    void Temperatures(Vec<Scalar> & T) const
+    {
+        const auto & network = *m_network;
+        T.resize(network.NodeSize());
+        for (size_t i = 0; i < network.NodeSize(); ++i) {
+            if (auto t = network[i].t; network.UNKNOWN_T != t) T[i] = t;
+        }
+        for (size_t mid = 0; mid < network.MatrixSize(); ++mid)
+            T[network.NodeId(mid)] = m_x[mid];
+    }
+
+    Scalar Temperature(Index nid) const
+    {
+        const auto & network = *m_network;
+        return network.UNKNOWN_T != network[nid].t ? network[nid].t : m_x[network.MatrixId(nid)];
+    }
+
+private:
+    /// A = C / h + G, refactorized only when h changes beyond round off, returns the factorized h
+    Scalar Factorize(Scalar h)
+    {
+        if (std::fabs(h - m_h) <= H_TOLERANCE * h) return m_h;
+        std::copy(m_G.valuePtr(), m_G.valuePtr() + m_G.nonZeros(), m_A.valuePtr());
+        m_pattern.AddDiagonal(m_c / h, m_A);
+        m_solver->Factorize(m_A);
+        m_h = h;
+        ++m_factorizations;
+        return h;
+    }
+
+    /// q(t) in matrix order, the excitation is evaluated once per scenario
+    void Load(Scalar time, Vector & q)
+    {
+        for (size_t s = 0; s < m_scenarios.size(); ++s)
+            m_ratios[s] = m_excitation(time, m_scenarios[s]);
+        q = m_fixed;
+        for (Eigen::Index mid = 0; mid < q.size(); ++mid)
+            q[mid] += INVALID_INDEX == m_rows[mid] ? m_power[mid] : m_power[mid] * m_ratios[m_rows[mid]];
+    }
+
+    void Accumulate()
+    {
+        m_step.iterations += Summary().iterations;
+        m_step.residual = std::max(m_step.residual, Summary().residual);
+        m_step.converged = m_step.converged && Summary().converged;
+    }
+
+    /// dT/dt = C^-1 (q - G T), zero on rows without capacitance
+    void Derivative(const Vector & x, const Vector & q, Vector & f) const
+    {
+        f = q - m_G * x;
+        for (Eigen::Index i = 0; i < f.size(); ++i)
+            f[i] = m_c[i] > 0 ? f[i] / m_c[i] : 0;
+    }
+
+    /// relative difference of steps sharing one factorization
+    inline static constexpr Scalar H_TOLERANCE = 1e-6;
+    inline static constexpr Scalar TR_BDF2_GAMMA = 2 - Scalar(1.41421356237309504880);
+    /// implicit weight of both stages, gamma / 2 = (1 - gamma) / (2 - gamma)
+    inline static constexpr Scalar TR_BDF2_W = TR_BDF2_GAMMA / 2;
+    /// BDF2 stage x1 = a xg - b x0 + w dt f1
+    inline static constexpr Scalar TR_BDF2_A = 1 / (TR_BDF2_GAMMA * (2 - TR_BDF2_GAMMA));
+    inline static constexpr Scalar TR_BDF2_B = TR_BDF2_A - 1;
+    /// error constant (-3 gamma^2 + 4 gamma - 2) / (12 (2 - gamma))
+    inline static constexpr Scalar TR_BDF2_K = (-3 * TR_BDF2_GAMMA * TR_BDF2_GAMMA + 4 * TR_BDF2_GAMMA - 2) / (12 * (2 - TR_BDF2_GAMMA));
+    inline static constexpr Scalar SAFETY = 0.9;
+    inline static constexpr Scalar MAX_STEP_GROWTH = 5;
+    inline static constexpr Scalar MIN_STEP_SHRINK = 0.2;
+    ThermalNetworkTransientSolverSettings m_settings;
+    Scalar m_time{0};
+    Scalar m_h{0};//h of the current factorization
+    size_t m_factorizations{0};
+    size_t m_rejections{0};
+    LinearSolveSummary m_step;
+    CPtr<ThermalNetwork<Scalar>> m_network{nullptr};
+    ThermalTransientExcitation m_excitation;
+    Matrix m_G, m_A;
+    ConductancePattern<Scalar> m_pattern;
+    UPtr<LinearSolver<Scalar>> m_solver;
+    Vector m_c;//lumped capacitance, unit: J/K
+    Vector m_x;
+    Vector m_power, m_fixed;//scalable node power and constant load of convection and fixed neighbors, unit: W
+    Vector m_q, m_q1;//load at the start and end of the step
+    Vec<Index> m_rows;//scenario slot of each row, INVALID_INDEX for constant power
+    Vec<Index> m_scenarios;
+    Vec<Scalar> m_ratios;
+};
 
-} // namespace nano::heat::solver::network
\ No newline at end of file
+} // namespace nano::heat::solver::network
@@ -0,0 +1,106 @@
+#pragma once
+#include "NSThermalNetworkSolver.hpp"
+
+#include <map>
+
+namespace nano::heat::solver::network {
+
+/// probe temperatures of a linear network as affine function of scenario powers, T = offset + influence^T * power
+/// each scenario keeps the spatial power distribution of the network it was built from,
+/// heat flow that is not scenario power (e.g. boundary heat flux) stays in the offset
+template <typename Scalar>
+class ThermalNetworkSuperposition
+{
+public:
+    using Matrix = DenseMatrix<Scalar>;
+    using Vector = DenseVector<Scalar>;
+    /// power maps solved together per batched linear solve
+    inline static constexpr size_t BATCH_BLOCK_SIZE = 32;
+
+    Vec<Index> sources;//scenario id of each influence row
+    Vector nominal;//scenario power of the network, unit: W
+    Vector offset;//probe temperatures with all scenario power off
+    Matrix influence;//sources x probes, probe temperature rise per watt of source, unit: K/W
+
+    size_t SourceSize() const { return sources.size(); }
+    size_t ProbeSize() const { return offset.size(); }
+
+    /// one unit response per scenario with nonzero power, probes in node index,
+    /// responses come from adjoint solves per probe when there are fewer probes than scenarios
+    void Build(CRef<ThermalNetwork<Scalar>> network, Scalar refT, const Vec<Index> & probes, CRef<ThermalNetworkLinearSolverSettings> settings = {})
+    {
+        std::map<Index, double> powers;
+        for (size_t i = 0; i < network.NodeSize(); ++i) {
+            const auto & node = network[i];
+            if (isValid(node.scen) && 0 != node.power) powers[node.scen] += node.power;
+        }
+        sources.clear();
+        HashMap<Index, Index> rows;
+        for (auto [scen, power] : powers) {
+            if (0 == power) continue;
+            rows.emplace(scen, sources.size());
+            sources.emplace_back(scen);
+        }
+        nominal.resize(sources.size());
+        for (size_t s = 0; s < sources.size(); ++s)
+            nominal[s] = powers.at(sources[s]);
+
+        //base: heat flow that does not belong to any source
+        Matrix hf(network.NodeSize(), 1), results;
+        for (size_t i = 0; i < network.NodeSize(); ++i)
+            hf(i, 0) = network[i].hf - (rows.count(network[i].scen) ? network[i].power : 0);
+        Vector base = hf.col(0);
+        ThermalNetworkStaticSolver<Scalar> solver(settings);
+        solver.Solve(network, refT, hf, results);
+        offset.resize(probes.size());
+        for (size_t p = 0; p < probes.size(); ++p)
+            offset[p] = results(probes[p], 0);
+
+        influence.resize(sources.size(), probes.size());
+        if (probes.size() < sources.size()) {
+            //influence(s, p) = y_p . u_s, u_s is the 1W distribution of scenario s
+            Matrix transfer, Y;
+            solver.SolveAdjoint(network, probes, transfer, Y);
+            influence.setZero();
+            for (size_t mid = 0; mid < network.MatrixSize(); ++mid) {
+                auto nid = network.NodeId(mid);
+                if (auto iter = rows.find(network[nid].scen); iter != rows.cend())
+                    influence.row(iter->second) += network[nid].power / nominal[iter->second] * Y.row(mid);
+            }
+            NS_TRACE("superposition of %1% sources at %2% probes by adjoint", sources.size(), probes.size());
+            return;
+        }
+        for (size_t begin = 0; begin < sources.size(); begin += BATCH_BLOCK_SIZE) {
+            auto cases = std::min(BATCH_BLOCK_SIZE, sources.size() - begin);
+            hf = base.replicate(1, cases);
+            for (size_t i = 0; i < network.NodeSize(); ++i) {
+                auto iter = rows.find(network[i].scen);
+                if (iter == rows.cend() || iter->second < begin || iter->second >= begin + cases) continue;
+                hf(i, iter->second - begin) += network[i].power / nominal[iter->second];//1W in total
+            }
+            solver.Solve(network, refT, hf, results);
+            for (size_t c = 0; c < cases; ++c)
+                for (size_t p = 0; p < probes.size(); ++p)
+                    influence(begin + c, p) = results(probes[p], c) - offset[p];
+        }
+        NS_TRACE("superposition of %1% sources at %2% probes", sources.size(), probes.size());
+    }
+
+    /// probe temperatures of source powers in sources order, unit: W
+    void Evaluate(const Vector & power, Vector & temperatures) const
+    {
+        NS_ASSERT(size_t(power.size()) == SourceSize());
+        temperatures = offset;
+        temperatures.noalias() += influence.transpose() * power;
+    }
+
+    /// many power vectors at once, powers: sources x cases, temperatures: probes x cases
+    void Evaluate(const Matrix & powers, Matrix & temperatures) const
+    {
+        NS_ASSERT(size_t(powers.rows()) == SourceSize());
+        temperatures.noalias() = influence.transpose() * powers;
+        temperatures.colwise() += offset;
+    }
+};
+
+} // namespace nano::heat::solver::network
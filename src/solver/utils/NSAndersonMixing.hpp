@@ -0,0 +1,56 @@
+#pragma once
+#include "basic/NSHeatAlias.hpp"
+
+#include <Eigen/Dense>
+namespace nano::heat::solver::utils {
+
+/// type II anderson mixing of fixed point iteration x = g(x) over a sliding window of the latest depth differences
+template <typename Scalar>
+class AndersonMixing
+{
+public:
+    explicit AndersonMixing(size_t depth) : m_depth(depth) { NS_ASSERT(depth > 0); }
+
+    /// x: current iterate, gx: g(x) on input and the next iterate on output
+    void Update(const Vec<Scalar> & x, Vec<Scalar> & gx)
+    {
+        NS_ASSERT(x.size() == gx.size());
+        const Eigen::Index n = x.size();
+        Eigen::VectorXd g = Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>(gx.data(), n).template cast<double>();
+        Eigen::VectorXd f = g - Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>(x.data(), n).template cast<double>();
+        if (0 == m_updates++ || m_f.size() != n) {
+            m_dF.resize(n, m_depth);
+            m_dG.resize(n, m_depth);
+            m_columns = 0;
+            m_f = std::move(f);
+            m_g = std::move(g);
+            return;
+        }
+        //oldest column is overwritten once the window is full
+        auto col = (m_updates - 2) % m_depth;
+        m_dF.col(col) = f - m_f;
+        m_dG.col(col) = g - m_g;
+        m_columns = std::min(m_columns + 1, m_depth);
+        m_f = f;
+        m_g = g;
+
+        //gamma = argmin |f - dF gamma|, x_next = g - dG gamma
+        Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(m_dF.leftCols(m_columns));
+        Eigen::VectorXd gamma = qr.solve(f);
+        if (not gamma.allFinite()) return;
+        g.noalias() -= m_dG.leftCols(m_columns) * gamma;
+        for (Eigen::Index i = 0; i < n; ++i)
+            gx[i] = Scalar(g[i]);
+    }
+
+    void Reset() { m_updates = 0; m_columns = 0; }
+
+private:
+    size_t m_depth;
+    size_t m_updates{0};
+    size_t m_columns{0};
+    Eigen::VectorXd m_f, m_g;
+    Eigen::MatrixXd m_dF, m_dG;
+};
+
+} // namespace nano::heat::solver::utils
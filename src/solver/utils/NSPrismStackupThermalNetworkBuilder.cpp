@@ -16,13 +16,15 @@ PrismStackupThermalNetworkBuilder<Scalar>::PrismStackupThermalNetworkBuilder(CPt
 }
 
 template <typename Scalar>
-void PrismStackupThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, Index start, Index end) const
+void PrismStackupThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, Accumulator & acc, Index start, Index end) const
 {
     const auto & model = *this->m_model;
     auto topBC = model.GetUniformBC(Orientation::TOP);
     auto botBC = model.GetUniformBC(Orientation::BOT);
     
-    auto & summary = PrismThermalNetworkBuilder<Scalar>::summary;
+    auto & edges = acc.edges;
+    auto & summary = acc.summary;
+    edges.reserve(3 * (end - start));
     for (size_t i = start; i < end; ++i) {
         const auto & inst = model.GetPrism(i);
         const auto & element = model.GetPrismElement(inst.layer, inst.element);
@@ -30,7 +32,8 @@ void PrismStackupThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scal
             auto p = lut->Lookup(iniT.at(i), /*extrapolation*/false);
             p *= element.powerRatio;
             summary.iHeatFlow += p;
-            network->AddHF(i, p);
+            network->AddPower(i, p);
+            network->AddSlope(i, this->GetPowerSlope(element.powerLutId, iniT.at(i)) * element.powerRatio);
             network->SetScenario(i, element.scenId);
         }
 
@@ -40,6 +43,7 @@ void PrismStackupThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scal
         network->SetC(i, c * rho * vol);
 
         auto k = this->GetMatThermalConductivity(element.matId, iniT.at(i));
+        auto dk = this->GetMatThermalConductivitySlope(element.matId, iniT.at(i));
         auto ct = this->GetPrismCenterPoint2D(i);
 
         const auto & neighbors = inst.neighbors;
@@ -60,9 +64,13 @@ void PrismStackupThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scal
                 auto r1 = dist2edge / kxy / vArea;
 
                 auto kNb = this->GetMatThermalConductivity(nbEle.matId, iniT.at(nid));
+                auto dkNb = this->GetMatThermalConductivitySlope(nbEle.matId, iniT.at(nid));
                 auto kNbXY = 0.5 * (kNb[0] + kNb[1]);
                 auto r2 = (dist - dist2edge) / kNbXY / vArea;
-                network->SetR(i, nid, r1 + r2);
+                //d(a / k)/dT = -(a / k) * k' / k
+                auto dr1 = -r1 * 0.5 * (dk[0] + dk[1]) / kxy;
+                auto dr2 = -r2 * 0.5 * (dkNb[0] + dkNb[1]) / kNbXY;
+                Network::AddR(edges, i, nid, r1 + r2, dr1, dr2);
             }
         }
         auto height = this->GetPrismHeight(i);
@@ -99,10 +107,11 @@ void PrismStackupThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scal
                 const auto & nbEle = model.GetPrismElement(nb.layer, nb.element);
                 auto hNb = this->GetPrismHeight(nTop);
                 auto kNb = this->GetMatThermalConductivity(nbEle.matId, iniT.at(nTop));
+                auto dkNb = this->GetMatThermalConductivitySlope(nbEle.matId, iniT.at(nTop));
                 auto area = hArea * contact.ratio;
-                auto r =  (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / area;
+                auto r1 = 0.5 * height / k[2] / area, r2 = 0.5 * hNb / kNb[2] / area;
                 // auto r = 0.5 * height / k[2] / hArea + 0.5 * hNb / kNb[2] / GetPrismTopBotArea(nTop);
-                network->SetR(i, nTop, r);
+                Network::AddR(edges, i, nTop, r1 + r2, -r1 * dk[2] / k[2], -r2 * dkNb[2] / kNb[2]);
             }
             if (ratio > 0 && nullptr != topBC && topBC->isValid()) {
                 if (ThermalBoundaryCondition::Type::HTC == topBC->type) {
@@ -156,10 +165,11 @@ void PrismStackupThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scal
                 const auto & nbEle = model.GetPrismElement(nb.layer, nb.element);
                 auto hNb = this->GetPrismHeight(nBot);
                 auto kNb = this->GetMatThermalConductivity(nbEle.matId, iniT.at(nBot));
+                auto dkNb = this->GetMatThermalConductivitySlope(nbEle.matId, iniT.at(nBot));
                 auto area = hArea * contact.ratio;
-                auto r =  (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / area;
+                auto r1 = 0.5 * height / k[2] / area, r2 = 0.5 * hNb / kNb[2] / area;
                 // auto r = 0.5 * height / k[2] / hArea + 0.5 * hNb / kNb[2] / GetPrismTopBotArea(nBot);
-                network->SetR(i, nBot, r);
+                Network::AddR(edges, i, nBot, r1 + r2, -r1 * dk[2] / k[2], -r2 * dkNb[2] / kNb[2]);
             }
             if (ratio > 0 && nullptr != botBC && botBC->isValid()) {
                 if (ThermalBoundaryCondition::Type::HTC == botBC->type) {
@@ -241,6 +251,33 @@ void PrismStackupThermalNetworkBuilder<Scalar>::ApplyBlockBCs(Ptr<Network> netwo
         applyBlockBC(block, false);
 }
 
+/// vertical contacts are many to many, each column follows the largest overlap into the layer below
+template <typename Scalar>
+void PrismStackupThermalNetworkBuilder<Scalar>::BuildColumns(Ptr<Network> network) const
+{
+    const auto & model = *this->m_model;
+    const size_t prisms = model.TotalPrismElements();
+    Vec<bool> visited(prisms, false);
+    Vec<Index> column;
+    for (size_t i = 0; i < prisms; ++i) {
+        if (visited[i]) continue;
+        column.clear();
+        for (auto n = i; INVALID_INDEX != n;) {
+            visited[n] = true;
+            column.emplace_back(n);
+            Float ratio = 0;
+            Index next = INVALID_INDEX;
+            for (const auto & contact : model.GetPrism(n).contacts.back()) {
+                if (contact.id >= prisms || visited[contact.id] || contact.ratio <= ratio) continue;
+                ratio = contact.ratio;
+                next = contact.id;
+            }
+            n = next;
+        }
+        if (column.size() > 1) network->AddColumn(column);
+    }
+}
+
 template class PrismStackupThermalNetworkBuilder<Float32>;
 template class PrismStackupThermalNetworkBuilder<Float64>;
 
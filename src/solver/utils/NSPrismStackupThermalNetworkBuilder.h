@@ -14,12 +14,14 @@ class PrismStackupThermalNetworkBuilder : public PrismThermalNetworkBuilder<Scal
 public:
     using ModelType = model::PrismStackupThermalModel;
     using Network = network::ThermalNetwork<Scalar>;
+    using Accumulator = typename PrismThermalNetworkBuilder<Scalar>::Accumulator;
     explicit PrismStackupThermalNetworkBuilder(CPtr<ModelType> model);
     virtual ~PrismStackupThermalNetworkBuilder() = default;
 
 private:
-    void BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, Index start, Index end) const override;
+    void BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, Accumulator & acc, Index start, Index end) const override;
     void ApplyBlockBCs(Ptr<Network> network) const override;
+    void BuildColumns(Ptr<Network> network) const override;
 };
 } // namespace solver::utils
 
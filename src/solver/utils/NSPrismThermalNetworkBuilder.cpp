@@ -5,6 +5,9 @@
 
 namespace nano::heat::solver::utils {
 
+/// temperature step of the central difference slopes, unit: K
+inline static constexpr Float SLOPE_STEP = 0.5;
+
 template <typename Scalar>
 PrismThermalNetworkBuilder<Scalar>::PrismThermalNetworkBuilder(CPtr<ModelType> model) : m_model(model) { NS_ASSERT(m_model); }
 
@@ -18,37 +21,90 @@ UPtr<typename PrismThermalNetworkBuilder<Scalar>::Network> PrismThermalNetworkBu
     summary.totalNodes = size;
     auto network = std::make_unique<Network>(size);
 
-    if (auto threads = nano::thread::Threads(); threads > 1) {
+    const size_t prisms = m_model->TotalPrismElements();
+    const size_t blocks = (prisms + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    Vec<Accumulator> accs(blocks);
+    if (auto threads = nano::thread::Threads(); threads > 1 && blocks > 1) {
         auto pool = nano::thread::Pool();
-        size_t size = m_model->TotalPrismElements();
-        size_t blocks = threads * 2;
-        size_t blockSize = size / blocks;
-
-        size_t begin = 0;
-        for(size_t i = 0; i < blocks && blockSize > 0; ++i){
-            size_t end = begin + blockSize;
-            pool.Submit(std::bind(&PrismThermalNetworkBuilder::BuildPrismElement, this, std::ref(iniT), network.get(), begin, end));
-            begin = end;
+        for (size_t i = 0; i < blocks; ++i) {
+            size_t begin = i * BLOCK_SIZE;
+            size_t end = std::min(begin + BLOCK_SIZE, prisms);
+            pool.Submit(std::bind(&PrismThermalNetworkBuilder::BuildPrismElement, this, std::ref(iniT), network.get(), std::ref(accs[i]), begin, end));
         }
-        size_t end = size;
-        if(begin != end)
-            pool.Submit(std::bind(&PrismThermalNetworkBuilder::BuildPrismElement, this, std::ref(iniT), network.get(), begin, end));        
         pool.Wait();
     }
-    else BuildPrismElement(iniT, network.get(), 0, m_model->TotalPrismElements());
+    else {
+        for (size_t i = 0; i < blocks; ++i)
+            BuildPrismElement(iniT, network.get(), accs[i], i * BLOCK_SIZE, std::min((i + 1) * BLOCK_SIZE, prisms));
+    }
+    //fixed order reduction
+    size_t edges{0};
+    for (const auto & acc : accs) edges += acc.edges.size();
+    network->ReserveEdges(edges + 2 * m_model->TotalLineElements());
+    for (auto & acc : accs) {
+        network->AppendEdges(acc.edges);
+        summary.Merge(acc.summary);
+        typename Network::Edges().swap(acc.edges);
+    }
     
     BuildLineElement(iniT, network.get());
     ApplyBlockBCs(network.get());
+    BuildColumns(network.get());
+    network->Finalize();
     network->BuildIndexMap();
+    Reorder(network.get());
     return network;
 }
 
 template <typename Scalar>
-void PrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, size_t start, size_t end) const
+void PrismThermalNetworkBuilder<Scalar>::Reorder(Ptr<Network> network) const
+{
+    if (Ordering::NATURAL == m_ordering) return;
+    if (m_order.empty() || m_orderTopology != network->Topology() || m_order.size() != network->MatrixSize()) {
+        m_orderTopology = network->Topology();
+        m_natural = network::makeOrderingReport(*network);
+        switch (m_ordering) {
+            case Ordering::RCM : m_order = network::makeRCMOrdering(*network); break;
+            case Ordering::HILBERT : m_order = network::makeHilbertOrdering(*network, GetNodePoints()); break;
+            case Ordering::NESTED_DISSECTION : m_order = network::makeNestedDissectionOrdering(*network); break;
+            default : return;
+        }
+        network->Reorder(m_order);
+        m_ordered = network::makeOrderingReport(*network);
+        NS_TRACE("matrix reordering, bandwidth: %1% -> %2%, profile: %3% -> %4%",
+            m_natural.bandwidth, m_ordered.bandwidth, m_natural.profile, m_ordered.profile);
+    }
+    else network->Reorder(m_order);
+    summary.natural = m_natural;
+    summary.ordered = m_ordered;
+}
+
+template <typename Scalar>
+Vec<Arr3<Float>> PrismThermalNetworkBuilder<Scalar>::GetNodePoints() const
+{
+    Vec<Arr3<Float>> points(m_model->TotalElements());
+    for (size_t i = 0; i < m_model->TotalPrismElements(); ++i) {
+        auto ct = GetPrismCenterPoint2D(i);
+        points[i] = {ct[0], ct[1], Float(m_model->GetPrism(i).layer)};
+    }
+    for (size_t i = 0; i < m_model->TotalLineElements(); ++i) {
+        const auto & line = m_model->GetLineElement(i);
+        const auto & p0 = m_model->GetPoint(line.endPts.front());
+        const auto & p1 = m_model->GetPoint(line.endPts.back());
+        points[line.id] = {Float(0.5) * (p0[0] + p1[0]), Float(0.5) * (p0[1] + p1[1]), Float(m_model->TotalLayers())};
+    }
+    return points;
+}
+
+template <typename Scalar>
+void PrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, Accumulator & acc, size_t start, size_t end) const
 {
     auto topBC = m_model->GetUniformBC(Orientation::TOP);
     auto botBC = m_model->GetUniformBC(Orientation::BOT);
     
+    auto & edges = acc.edges;
+    auto & summary = acc.summary;
+    edges.reserve(3 * (end - start));
     for (size_t i = start; i < end; ++i) {
         const auto & inst = m_model->GetPrism(i);
         const auto & element = m_model->GetPrismElement(inst.layer, inst.element);
@@ -56,7 +112,8 @@ void PrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & i
             auto p = lut->Lookup(iniT.at(i), /*extrapolation*/false);
             p *= element.powerRatio;
             summary.iHeatFlow += p;
-            network->AddHF(i, p);
+            network->AddPower(i, p);
+            network->AddSlope(i, GetPowerSlope(element.powerLutId, iniT.at(i)) * element.powerRatio);
             network->SetScenario(i, element.scenId);
         }
 
@@ -66,6 +123,7 @@ void PrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & i
         network->SetC(i, c * rho * vol);
 
         auto k = GetMatThermalConductivity(element.matId, iniT.at(i));
+        auto dk = GetMatThermalConductivitySlope(element.matId, iniT.at(i));
         auto ct = GetPrismCenterPoint2D(i);
 
         const auto & neighbors = inst.neighbors;
@@ -86,9 +144,13 @@ void PrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & i
                 auto r1 = dist2edge / kxy / vArea;
 
                 auto kNb = GetMatThermalConductivity(nbEle.matId, iniT.at(nid));
+                auto dkNb = GetMatThermalConductivitySlope(nbEle.matId, iniT.at(nid));
                 auto kNbXY = 0.5 * (kNb[0] + kNb[1]);
                 auto r2 = (dist - dist2edge) / kNbXY / vArea;
-                network->SetR(i, nid, r1 + r2);
+                //d(a / k)/dT = -(a / k) * k' / k
+                auto dr1 = -r1 * 0.5 * (dk[0] + dk[1]) / kxy;
+                auto dr2 = -r2 * 0.5 * (dkNb[0] + dkNb[1]) / kNbXY;
+                Network::AddR(edges, i, nid, r1 + r2, dr1, dr2);
             }
         }
         auto height = GetPrismHeight(i);
@@ -119,8 +181,9 @@ void PrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & i
             const auto & nbEle = m_model->GetPrismElement(nb.layer, nb.element);
             auto hNb = GetPrismHeight(nTop);
             auto kNb = GetMatThermalConductivity(nbEle.matId, iniT.at(nTop));
-            auto r = (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / hArea;
-            network->SetR(i, nTop, r);
+            auto dkNb = GetMatThermalConductivitySlope(nbEle.matId, iniT.at(nTop));
+            auto r1 = 0.5 * height / k[2] / hArea, r2 = 0.5 * hNb / kNb[2] / hArea;
+            Network::AddR(edges, i, nTop, r1 + r2, -r1 * dk[2] / k[2], -r2 * dkNb[2] / kNb[2]);
         }
         //bot
         auto nBot = neighbors.at(model::PrismElement::BOT_NEIGHBOR_INDEX);
@@ -148,12 +211,27 @@ void PrismThermalNetworkBuilder<Scalar>::BuildPrismElement(const Vec<Scalar> & i
             const auto & nbEle = m_model->GetPrismElement(nb.layer, nb.element);
             auto hNb = GetPrismHeight(nBot);
             auto kNb = GetMatThermalConductivity(nbEle.matId, iniT.at(nBot));
-            auto r = (0.5 * height / k[2] + 0.5 * hNb / kNb[2]) / hArea;
-            network->SetR(i, nBot, r);
+            auto dkNb = GetMatThermalConductivitySlope(nbEle.matId, iniT.at(nBot));
+            auto r1 = 0.5 * height / k[2] / hArea, r2 = 0.5 * hNb / kNb[2] / hArea;
+            Network::AddR(edges, i, nBot, r1 + r2, -r1 * dk[2] / k[2], -r2 * dkNb[2] / kNb[2]);
         }
     }
 }
 
+template <typename Scalar>
+void PrismThermalNetworkBuilder<Scalar>::BuildColumns(Ptr<Network> network) const
+{
+    Vec<Index> column;
+    for (size_t i = 0; i < m_model->TotalPrismElements(); ++i) {
+        const auto & inst = m_model->GetPrism(i);
+        if (INVALID_INDEX != inst.neighbors.at(model::PrismElement::TOP_NEIGHBOR_INDEX)) continue;
+        column.clear();
+        for (auto n = i; INVALID_INDEX != n; n = m_model->GetPrism(n).neighbors.at(model::PrismElement::BOT_NEIGHBOR_INDEX))
+            column.emplace_back(n);
+        if (column.size() > 1) network->AddColumn(column);
+    }
+}
+
 template <typename Scalar>
 void PrismThermalNetworkBuilder<Scalar>::BuildLineElement(const Vec<Scalar> & iniT, Ptr<Network> network) const
 {
@@ -167,29 +245,35 @@ void PrismThermalNetworkBuilder<Scalar>::BuildLineElement(const Vec<Scalar> & in
 
         network->SetScenario(index, line.scenId);
         if (auto jh = GetLineJouleHeat(index, iniT.at(index)); jh > 0) {
-            network->AddHF(index, jh);
+            network->AddPower(index, jh);
+            network->AddSlope(index, GetLineJouleHeatSlope(index, iniT.at(index)));
             summary.iHeatFlow += jh;
             summary.jouleHeat += jh;
         }
         
         auto k = GetMatThermalConductivity(line.matId, iniT.at(index));
+        auto dk = GetMatThermalConductivitySlope(line.matId, iniT.at(index));
         auto aveK = (k[0] + k[1] + k[2]) / 3;
+        auto aveDK = (dk[0] + dk[1] + dk[2]) / 3;
         auto area = GetLineArea(index);
         auto l = GetLineLength(index);
 
         auto setR = [&](size_t nbIndex) {
             if (m_model->isPrism(nbIndex)) {
                 auto r = 0.5 * l / aveK / area;
-                network->SetR(nbIndex, index, r);
+                network->SetR(nbIndex, index, r, 0, -r * aveDK / aveK);
             }
             else if (index < nbIndex) {
                 const auto & lineNb = m_model->GetLineElement(m_model->LineLocalIndex(nbIndex));
                 auto kNb = GetMatThermalConductivity(lineNb.matId, iniT.at(index));
+                auto dkNb = GetMatThermalConductivitySlope(lineNb.matId, iniT.at(index));
                 auto aveKNb = (kNb[0] + kNb[1] + kNb[2]) / 3;
+                auto aveDKNb = (dkNb[0] + dkNb[1] + dkNb[2]) / 3;
                 auto areaNb = GetLineArea(nbIndex);
                 auto lNb = GetLineLength(nbIndex);
-                auto r = 0.5 * l / aveK / area + 0.5 * lNb / aveKNb / areaNb;
-                network->SetR(index, nbIndex, r);
+                auto r1 = 0.5 * l / aveK / area, r2 = 0.5 * lNb / aveKNb / areaNb;
+                //both halves are evaluated at the temperature of this line
+                network->SetR(index, nbIndex, r1 + r2, -r1 * aveDK / aveK - r2 * aveDKNb / aveKNb, 0);
             }
         };
         for (auto nb : line.neighbors.front()) setR(nb);
@@ -413,6 +497,33 @@ Float PrismThermalNetworkBuilder<Scalar>::GetMatResistivity(Index matId, Float r
     return result;
 }
 
+template <typename Scalar>
+Arr3<Float> PrismThermalNetworkBuilder<Scalar>::GetMatThermalConductivitySlope(Index matId, Float refT) const
+{
+    Arr3<Float> result{0, 0, 0};
+    if (not m_slopes) return result;
+    auto k1 = GetMatThermalConductivity(matId, refT - SLOPE_STEP);
+    auto k2 = GetMatThermalConductivity(matId, refT + SLOPE_STEP);
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i] = (k2[i] - k1[i]) / (2 * SLOPE_STEP);
+    return result;
+}
+
+template <typename Scalar>
+Float PrismThermalNetworkBuilder<Scalar>::GetPowerSlope(Index lutId, Float refT) const
+{
+    if (not m_slopes) return 0;
+    auto lut = CId<LookupTable>(lutId); { NS_ASSERT(lut); }
+    return (lut->Lookup(refT + SLOPE_STEP, /*extrapolation*/false) - lut->Lookup(refT - SLOPE_STEP, /*extrapolation*/false)) / (2 * SLOPE_STEP);
+}
+
+template <typename Scalar>
+Float64 PrismThermalNetworkBuilder<Scalar>::GetLineJouleHeatSlope(Index index, Float refT) const
+{
+    if (not m_slopes) return 0;
+    return (GetLineJouleHeat(index, refT + SLOPE_STEP) - GetLineJouleHeat(index, refT - SLOPE_STEP)) / (2 * SLOPE_STEP);
+}
+
 template class PrismThermalNetworkBuilder<Float32>;
 template class PrismThermalNetworkBuilder<Float64>;
 
@@ -1,6 +1,6 @@
 #pragma once
 #include "basic/NSHeatCommon.hpp"
-#include "solver/network/NSThermalNetwork.hpp"
+#include "solver/network/NSThermalNetworkOrdering.hpp"
 
 namespace nano::heat {
 namespace model { class PrismThermalModel; }
@@ -12,7 +12,16 @@ struct ThermalNetworkBuildSummary
     size_t fixedTNodes = 0;
     size_t boundaryNodes = 0;
     double iHeatFlow = 0, oHeatFlow = 0, jouleHeat = 0;
+    network::OrderingReport natural, ordered;//matrix envelope before and after reordering
     void Reset() { *this = ThermalNetworkBuildSummary{}; }
+    void Merge(const ThermalNetworkBuildSummary & other)
+    {
+        fixedTNodes += other.fixedTNodes;
+        boundaryNodes += other.boundaryNodes;
+        iHeatFlow += other.iHeatFlow;
+        oHeatFlow += other.oHeatFlow;
+        jouleHeat += other.jouleHeat;
+    }
 };
 
 template <typename Scalar>
@@ -22,20 +31,46 @@ public:
     mutable ThermalNetworkBuildSummary summary;
     using ModelType = model::PrismThermalModel;
     using Network = network::ThermalNetwork<Scalar>;
+    using Ordering = ThermalNetworkLinearSolverSettings::Ordering;
+    /// prisms are assembled in fixed size blocks, the result is independent of thread count
+    inline static constexpr size_t BLOCK_SIZE = 4096;
+    /// per block output, merged in block order after parallel assembly
+    struct Accumulator
+    {
+        typename Network::Edges edges;
+        ThermalNetworkBuildSummary summary;
+    };
     explicit PrismThermalNetworkBuilder(CPtr<ModelType> model);
 
     UPtr<Network> Build(const Vec<Scalar> & iniT) const;
 
+    /// matrix row order of built networks
+    void SetOrdering(Ordering ordering) { m_ordering = ordering; m_order.clear(); }
+
+    /// also put the temperature slopes of power and resistors into built networks, needed by newton iterations
+    void SetSlopes(bool slopes) { m_slopes = slopes; }
+
 protected:
-    virtual void BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, Index start, Index end) const;
+    virtual void BuildPrismElement(const Vec<Scalar> & iniT, Ptr<Network> network, Accumulator & acc, Index start, Index end) const;
     virtual void ApplyBlockBCs(Ptr<Network> network) const;
+    /// vertical prism columns through top/bot neighbors
+    virtual void BuildColumns(Ptr<Network> network) const;
     void BuildLineElement(const Vec<Scalar> & iniT, Ptr<Network> network) const;
+    /// the order is computed once and reused while the network topology in natural order is unchanged
+    void Reorder(Ptr<Network> network) const;
+    /// [x, y, layer] of prism centers, lines at their midpoint with layer TotalLayers(), used by spatial ordering
+    Vec<Arr3<Float>> GetNodePoints() const;
 
     Arr3<Float> GetMatThermalConductivity(Index matId, Float refT) const;
     Float GetMatMassDensity(Index matId, Float refT) const;
     Float GetMatSpecificHeat(Index matId, Float refT) const;
     Float GetMatResistivity(Index matId, Float refT) const;
 
+    /// temperature derivatives by central difference of the value queries, zero unless slopes are enabled
+    Arr3<Float> GetMatThermalConductivitySlope(Index matId, Float refT) const;
+    Float GetPowerSlope(Index lutId, Float refT) const;
+    Float64 GetLineJouleHeatSlope(Index index, Float refT) const;
+
     /// global index
     const FCoord3D & GetPrismVertexPoint(Index index, Index iv) const;
     FCoord2D GetPrismVertexPoint2D(Index index, Index iv) const;
@@ -56,6 +91,11 @@ protected:
 
 protected:
     CPtr<ModelType> m_model;
+    Ordering m_ordering{Ordering::NATURAL};
+    bool m_slopes{false};
+    mutable size_t m_orderTopology{0};//natural order topology the cached order belongs to
+    mutable Vec<Index> m_order;
+    mutable network::OrderingReport m_natural, m_ordered;
 };
 
 } // namespace solver::utils
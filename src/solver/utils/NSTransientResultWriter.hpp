@@ -0,0 +1,295 @@
+#pragma once
+#include "basic/NSHeatAlias.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <deque>
+#include <mutex>
+namespace nano::heat::solver::utils {
+
+/// layout of transient result files, all values little endian as in memory:
+/// header | chunk ... | index, the header is patched with the index position on close,
+/// each chunk is an index entry followed by its payload, a probe chunk holds count step times (Float64) then count rows of
+/// probe values (Float32), a field chunk holds one step time (Float64) then the temperatures of all nodes (Float32)
+namespace transient {
+
+inline constexpr uint32_t MAGIC = 0x5254534e;//"NSTR"
+inline constexpr uint32_t VERSION = 1;
+
+enum class Stream : uint32_t { PROBE = 1, FIELD = 2 };
+
+struct Header
+{
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint64_t probes = 0;//probe values per step
+    uint64_t nodes = 0;//temperatures per field snapshot
+    uint64_t interval = 0;//steps between field snapshots, 0: no field
+    uint64_t index = 0;//file position of the index, 0: file not closed
+    uint64_t chunks = 0;//index entries
+};
+
+struct Chunk
+{
+    Stream stream = Stream::PROBE;
+    uint32_t reserved = 0;
+    uint64_t first = 0;//step of the first record
+    uint64_t count = 0;//records
+    uint64_t offset = 0;//file position of the payload
+};
+
+} // namespace transient
+
+/// append-only chunked binary sink of transient results with bounded memory,
+/// probe rows are packed into chunks of chunkSteps steps and field snapshots are one chunk each,
+/// full chunks are handed to a background thread that owns the file, so the solver only copies values,
+/// at most maxPending chunks are queued, the solver waits for the disk only when the queue is full
+class TransientResultWriter
+{
+public:
+    using Chunk = transient::Chunk;
+    using Header = transient::Header;
+    using Stream = transient::Stream;
+
+    TransientResultWriter(std::string filename, size_t probes, size_t nodes, size_t interval, size_t chunkSteps = 4096, size_t maxPending = 8)
+     : m_chunkSteps(std::max<size_t>(1, chunkSteps)), m_maxPending(std::max<size_t>(1, maxPending))
+    {
+        m_header.probes = probes;
+        m_header.nodes = nodes;
+        m_header.interval = nodes > 0 ? interval : 0;
+        m_out.open(filename, std::ios::binary | std::ios::trunc);
+        if (not m_out.is_open()) {
+            NS_TRACE("failed to open transient result file %1%", filename);
+            return;
+        }
+        Write(&m_header, sizeof(Header));
+        m_thread = std::thread([this] { Run(); });
+    }
+
+    ~TransientResultWriter() { Close(); }
+
+    bool isOpen() const { return m_thread.joinable(); }
+    size_t Steps() const { return m_steps; }
+
+    /// whether the step appended next is due for a field snapshot
+    bool NeedField() const { return m_header.interval > 0 && 0 == m_steps % m_header.interval; }
+
+    /// one step of probe values, field: temperatures of all nodes when NeedField() before this call
+    template <typename Probes, typename Field = Vec<Float32>>
+    void Append(Float64 time, const Probes & probes, const Field * field = nullptr)
+    {
+        if (not isOpen()) return;
+        NS_ASSERT(size_t(probes.size()) == m_header.probes);
+        if (field && NeedField()) {
+            NS_ASSERT(size_t(field->size()) == m_header.nodes);
+            Job job{Chunk{Stream::FIELD, 0, m_steps, 1, 0}, Acquire()};
+            job.data.resize(sizeof(Float64) + sizeof(Float32) * m_header.nodes);
+            std::memcpy(job.data.data(), &time, sizeof(Float64));
+            auto * values = reinterpret_cast<Float32 *>(job.data.data() + sizeof(Float64));
+            for (size_t i = 0; i < m_header.nodes; ++i) values[i] = (*field)[i];
+            Push(std::move(job));
+        }
+        if (0 == m_times.size()) m_first = m_steps;
+        m_times.emplace_back(time);
+        for (size_t p = 0; p < m_header.probes; ++p) m_rows.emplace_back(probes[p]);
+        if (m_times.size() == m_chunkSteps) Flush();
+        m_steps++;
+    }
+
+    /// writes the pending rows and the index, returns false if any write failed
+    bool Close()
+    {
+        if (not isOpen()) return m_header.index > 0 && not m_failed;
+        Flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+        }
+        m_work.notify_one();
+        m_thread.join();
+        m_header.index = m_position;
+        m_header.chunks = m_index.size();
+        Write(m_index.data(), sizeof(Chunk) * m_index.size());
+        m_out.seekp(0);
+        Write(&m_header, sizeof(Header));
+        m_out.close();
+        if (m_failed) NS_TRACE("failed to write transient result file");
+        return not m_failed;
+    }
+
+private:
+    struct Job
+    {
+        Chunk chunk;
+        Vec<char> data;
+    };
+
+    void Flush()
+    {
+        if (m_times.empty()) return;
+        const size_t count = m_times.size();
+        Job job{Chunk{Stream::PROBE, 0, m_first, count, 0}, Acquire()};
+        job.data.resize(sizeof(Float64) * count + sizeof(Float32) * m_rows.size());
+        std::memcpy(job.data.data(), m_times.data(), sizeof(Float64) * count);
+        std::memcpy(job.data.data() + sizeof(Float64) * count, m_rows.data(), sizeof(Float32) * m_rows.size());
+        m_times.clear();
+        m_rows.clear();
+        Push(std::move(job));
+    }
+
+    /// recycled buffer of a written chunk, keeps allocations bounded by the queue length
+    Vec<char> Acquire()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pool.empty()) return {};
+        auto data = std::move(m_pool.back());
+        m_pool.pop_back();
+        return data;
+    }
+
+    void Push(Job job)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_space.wait(lock, [this] { return m_queue.size() < m_maxPending; });
+        m_queue.emplace_back(std::move(job));
+        lock.unlock();
+        m_work.notify_one();
+    }
+
+    void Run()
+    {
+        for (;;) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work.wait(lock, [this] { return m_done || not m_queue.empty(); });
+            if (m_queue.empty()) return;
+            auto job = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+            m_space.notify_one();
+
+            job.chunk.offset = m_position + sizeof(Chunk);
+            Write(&job.chunk, sizeof(Chunk));
+            Write(job.data.data(), job.data.size());
+            m_index.emplace_back(job.chunk);
+
+            lock.lock();
+            if (m_pool.size() < m_maxPending) m_pool.emplace_back(std::move(job.data));
+        }
+    }
+
+    void Write(const void * data, size_t size)
+    {
+        m_out.write(reinterpret_cast<const char *>(data), size);
+        m_position += size;
+        if (not m_out.good()) m_failed = true;
+    }
+
+    Header m_header;
+    size_t m_chunkSteps;
+    size_t m_maxPending;
+    size_t m_steps{0};
+    size_t m_first{0};//step of the first pending row
+    Vec<Float64> m_times;//pending probe chunk
+    Vec<Float32> m_rows;
+
+    //file state is owned by the background thread until it is joined
+    std::ofstream m_out;
+    uint64_t m_position{0};
+    Vec<Chunk> m_index;
+    std::atomic<bool> m_failed{false};
+
+    std::mutex m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_space;
+    std::deque<Job> m_queue;
+    Vec<Vec<char>> m_pool;
+    bool m_done{false};
+    std::thread m_thread;
+};
+
+/// random access to a file of TransientResultWriter through its index
+class TransientResultReader
+{
+public:
+    using Chunk = transient::Chunk;
+    using Header = transient::Header;
+    using Stream = transient::Stream;
+
+    /// fails on files that were not closed
+    bool Open(std::string_view filename)
+    {
+        m_in.open(std::string(filename), std::ios::binary);
+        if (not m_in.is_open() || not Read(0, &m_header, sizeof(Header))) return false;
+        if (transient::MAGIC != m_header.magic || transient::VERSION != m_header.version || 0 == m_header.index) return false;
+        m_index.resize(m_header.chunks);
+        return Read(m_header.index, m_index.data(), sizeof(Chunk) * m_index.size());
+    }
+
+    const Header & GetHeader() const { return m_header; }
+
+    size_t Steps() const
+    {
+        size_t steps{0};
+        for (const auto & chunk : m_index)
+            if (Stream::PROBE == chunk.stream) steps += chunk.count;
+        return steps;
+    }
+
+    /// step indices of the field snapshots
+    Vec<size_t> Snapshots() const
+    {
+        Vec<size_t> steps;
+        for (const auto & chunk : m_index)
+            if (Stream::FIELD == chunk.stream) steps.emplace_back(chunk.first);
+        return steps;
+    }
+
+    /// times: time of each step, waveforms: values of each probe over the steps
+    bool ReadProbes(Vec<Float64> & times, Vec<Vec<Float32>> & waveforms)
+    {
+        const size_t probes = m_header.probes;
+        times.assign(Steps(), 0);
+        waveforms.assign(probes, Vec<Float32>(times.size()));
+        Vec<Float32> rows;
+        for (const auto & chunk : m_index) {
+            if (Stream::PROBE != chunk.stream) continue;
+            NS_ASSERT(chunk.first + chunk.count <= times.size());
+            rows.resize(chunk.count * probes);
+            if (not Read(chunk.offset, times.data() + chunk.first, sizeof(Float64) * chunk.count) ||
+                not Read(chunk.offset + sizeof(Float64) * chunk.count, rows.data(), sizeof(Float32) * rows.size())) return false;
+            for (size_t s = 0; s < chunk.count; ++s)
+                for (size_t p = 0; p < probes; ++p)
+                    waveforms[p][chunk.first + s] = rows[s * probes + p];
+        }
+        return true;
+    }
+
+    /// full field snapshot of the step, false if the step has no snapshot
+    bool ReadField(size_t step, Float64 & time, Vec<Float32> & temperatures)
+    {
+        for (const auto & chunk : m_index) {
+            if (Stream::FIELD != chunk.stream || chunk.first != step) continue;
+            temperatures.resize(m_header.nodes);
+            return Read(chunk.offset, &time, sizeof(Float64)) &&
+                   Read(chunk.offset + sizeof(Float64), temperatures.data(), sizeof(Float32) * temperatures.size());
+        }
+        return false;
+    }
+
+private:
+    bool Read(uint64_t position, void * data, size_t size)
+    {
+        m_in.seekg(position);
+        m_in.read(reinterpret_cast<char *>(data), size);
+        return m_in.good();
+    }
+
+    std::ifstream m_in;
+    Header m_header;
+    Vec<Chunk> m_index;
+};
+
+} // namespace nano::heat::solver::utils
@@ -3,10 +3,95 @@
 
 #include <nano/db>
 #include "simulation/NSSimulationPrismThermal.h"
+#include "solver/utils/NSPrismThermalNetworkBuilder.h"
+#include "solver/NSSolverPrismThermalNetwork.h"
 #include "model/NSModel.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace boost::unit_test;
 
+namespace detail {
+
+/// copper plate with a component whose power rises 0.3 W/K from 10 W at 25 C, cooled through a 5000 W/m^2-K bottom,
+/// the plate conducts 0.5 W/K to ambient, so each picard iteration only removes 40% of the error
+inline auto CreateSteepPowerModel(const std::string & name)
+{
+    using namespace nano;
+    using namespace nano::package;
+    nano::SetCurrentDir(generic::fs::DirName(__FILE__).string() + "/data/package/simple");
+    Database::Create(name);
+    auto pkg = nano::Create<Package>(name);
+    detail::SetupMaterials(pkg);
+
+    CoordUnit coordUnit(CoordUnit::Unit::Millimeter);
+    pkg->SetCoordUnit(coordUnit);
+    auto matCu = pkg->GetMaterialLib()->FindMaterial("Cu");
+    auto topLayer = pkg->AddStackupLayer(nano::Create<StackupLayer>("Top", LayerType::CONDUCTING, 0, 0.3, matCu, matCu));
+
+    auto topCell = nano::Create<CircuitCell>("Top", pkg);
+    auto layout = topCell->SetLayout(nano::Create<Layout>(CId<CircuitCell>(topCell)));
+    pkg->AddCell(topCell);
+    auto boundary = nano::Create<ShapeRect>(coordUnit, FCoord2D(0, 0), FCoord2D(10, 10));
+    layout->SetBoundary(boundary);
+    auto net = nano::Create<Net>("Net", layout);
+    layout->AddNet(net);
+    layout->AddConnObj(nano::Create<RoutingWire>(net, topLayer, boundary));
+
+    auto fpCell = nano::Create<FootprintCell>("Comp", pkg);
+    pkg->AddCell(fpCell);
+    auto fpBoundary = nano::Create<ShapeRect>(coordUnit, FCoord2D(0, 0), FCoord2D(5, 5));
+    fpCell->SetBoundary(fpBoundary);
+    fpCell->SetComponentType(ComponentType::IC);
+    fpCell->SetMaterial(matCu);
+    fpCell->SetHeight(0.5);
+    auto footprint = nano::Create<Footprint>("Top", fpCell, FootprintLocation::BOT);
+    fpCell->AddFootprint(footprint);
+    footprint->SetBoundary(fpBoundary);
+    footprint->SetSolderBallBumpThickness(0);
+    footprint->SetSolderFillingMaterial(matCu);
+    footprint->SetSolderMaterial(matCu);
+    auto comp = nano::Create<Component>("Comp", fpCell, layout);
+    auto compLayer = nano::Create<ComponentLayer>("CompLayer", comp, footprint);
+    compLayer->SetConnectedLayer(topLayer);
+    comp->AddComponentLayer(compLayer);
+    layout->AddComponent(comp);
+
+    auto powerLut = nano::Create<LookupTable1D>(
+        Vec<Float>{TempUnit(25).inKelvins(), TempUnit(125).inKelvins(), TempUnit(225).inKelvins()}, Vec<Float>{10, 40, 70});
+    comp->Bind<power::LossPower>(nano::Create<power::LossPower>("power", ScenarioId(0), powerLut));
+
+    using namespace nano::heat;
+    PrismThermalModelExtractionSettings settings;
+    auto & meshSettings = settings.meshSettings;
+    meshSettings.minAlpha = 15;
+    meshSettings.minLen = 1e-1;
+    meshSettings.maxLen = 1e+1;
+    meshSettings.tolerance = 0;
+    meshSettings.maxIter = 0;
+    meshSettings.dumpMeshFile = false;
+    settings.bcSettings.SetBotUniformBC(ThermalBoundaryCondition::Type::HTC, 5000);
+    return model::CreatePrismThermalModel(layout, settings);
+}
+
+/// static P-T solve of all nodes without dumps, iterated until converged
+inline nano::heat::ThermalNetworkStaticSolverSettings CreateStaticSettings(size_t nodes)
+{
+    using namespace nano::heat;
+    ThermalNetworkStaticSolverSettings settings;
+    settings.dumpHotmap = false;
+    settings.dumpResult = false;
+    settings.maxIter = 50;
+    settings.envT = TempUnit(25, TempUnit::Unit::Celsius);
+    settings.probs.resize(nodes);
+    std::iota(settings.probs.begin(), settings.probs.end(), 0);
+    return settings;
+}
+
+} // namespace detail
+
 void t_prism_thermal_simulation_simple()
 {
     using namespace nano;
@@ -144,6 +229,53 @@ void t_prism_thermal_simulation_wolfspeed()
     Database::Shutdown();
 }
 
+void t_prism_thermal_network_deterministic()
+{
+    using namespace nano;
+    using namespace nano::heat;
+    auto filename = generic::fs::DirName(__FILE__).string() + "/data/archive/CAS300M12BM2.nano/database.bin";
+    auto res = Database::Load(filename, ArchiveFormat::BIN);
+    BOOST_CHECK(res);
+
+    unsigned int version{0};
+    heat::model::PrismThermalModel model;
+    filename = std::string(nano::CurrentDir()) + "/model.prism.thermal.bin";
+    res = nano::Load(model, version, filename, ArchiveFormat::BIN);
+    BOOST_CHECK(res);
+
+    //network assembly is bit identical for any thread count of the builder pool and openmp
+    auto threads = nano::thread::Threads();
+#ifdef _OPENMP
+    auto ompThreads = omp_get_max_threads();
+#endif
+    Vec<Float64> iniT(model.TotalElements(), TempUnit(25, TempUnit::Unit::Celsius).inKelvins());
+    auto build = [&](size_t n) {
+        nano::thread::SetThreads(n);
+#ifdef _OPENMP
+        omp_set_num_threads(int(n));
+#endif
+        return solver::utils::PrismThermalNetworkBuilder<Float64>(&model).Build(iniT);
+    };
+    auto reference = build(1);
+    for (size_t n : {2, 8}) {
+        auto network = build(n);
+        BOOST_CHECK(network->Topology() == reference->Topology());
+        bool identical = network->NodeSize() == reference->NodeSize();
+        for (size_t i = 0; i < reference->NodeSize() && identical; ++i) {
+            const auto & a = (*network)[i], & b = (*reference)[i];
+            auto ga = network->Conductances(i), gb = reference->Conductances(i);
+            identical = a.hf == b.hf && a.htc == b.htc && a.c == b.c && a.t == b.t && a.scen == b.scen &&
+                        std::equal(ga.begin(), ga.end(), gb.begin(), gb.end());
+        }
+        BOOST_CHECK(identical);
+    }
+    nano::thread::SetThreads(threads);
+#ifdef _OPENMP
+    omp_set_num_threads(ompThreads);
+#endif
+    Database::Shutdown();
+}
+
 void t_prism_stackup_thermal_simulation_wolfspeed()
 {
     using namespace nano;
@@ -228,12 +360,85 @@ void t_prism_thermal_simulation2()
     Database::Shutdown();
 }
 
+void t_prism_thermal_network_warm_start()
+{
+    using namespace nano;
+    using namespace nano::heat;
+    using Solver = ThermalNetworkLinearSolverSettings::Solver;
+    using Preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner;
+    auto model = detail::CreateSteepPowerModel("warm_start");
+    BOOST_CHECK(model);
+
+    //inexact P-T iterations on a reordered network, the warm start maps the node order guess to matrix order
+    auto settings = detail::CreateStaticSettings(model->TotalElements());
+    settings.linearSettings.solver = Solver::CG;
+    settings.linearSettings.preconditioner = Preconditioner::JACOBI;
+    settings.linearSettings.ordering = ThermalNetworkLinearSolverSettings::Ordering::RCM;
+    settings.linearSettings.tolerance = 1e-8;
+    auto solve = [&](bool warmStart, Vec<Float> & temperatures) {
+        solver::PrismThermalNetworkStaticSolver solver(model.get());
+        solver.settings = settings;
+        solver.settings.warmStart = warmStart;
+        solver.Solve(temperatures);
+        return solver.summary;
+    };
+    Vec<Float> cold, warm;
+    auto coldSummary = solve(false, cold);
+    auto warmSummary = solve(true, warm);
+    for (const auto & summary : {coldSummary, warmSummary}) {
+        BOOST_CHECK(summary.residual <= settings.residual);
+        BOOST_CHECK(summary.linearHistory.size() >= 2);
+        //the forcing term schedule only tightens, the last solve ran at full linear tolerance
+        BOOST_CHECK(summary.linearTolerance == settings.linearSettings.tolerance);
+    }
+    for (size_t i = 0; i < cold.size(); ++i)
+        BOOST_CHECK_SMALL(warm[i] - cold[i], 2 * settings.residual);
+
+    //late iterations start close to their solution, so they take fewer CG steps than from zero
+    BOOST_CHECK(warmSummary.linearIterations < coldSummary.linearIterations);
+    BOOST_CHECK(warmSummary.linearHistory.back() < coldSummary.linearHistory.back());
+    Database::Shutdown();
+}
+
+void t_prism_thermal_network_newton()
+{
+    using namespace nano;
+    using namespace nano::heat;
+    using Method = ThermalNetworkStaticSolverSettings::Method;
+    auto model = detail::CreateSteepPowerModel("newton");
+    BOOST_CHECK(model);
+
+    //the builder puts the LUT and conductivity slopes into the network, no second build per iteration
+    auto settings = detail::CreateStaticSettings(model->TotalElements());
+    auto solve = [&](Method method, Vec<Float> & temperatures) {
+        solver::PrismThermalNetworkStaticSolver solver(model.get());
+        solver.settings = settings;
+        solver.settings.method = method;
+        solver.Solve(temperatures);
+        return solver.summary;
+    };
+    Vec<Float> newton, picard;
+    auto newtonSummary = solve(Method::NEWTON, newton);
+    auto picardSummary = solve(Method::PICARD, picard);
+    BOOST_CHECK(newtonSummary.residual <= settings.residual);
+    BOOST_CHECK(picardSummary.residual <= settings.residual);
+    //one LU solve per newton iteration, picard removes only 40% of the error per iteration
+    BOOST_CHECK(newtonSummary.linearHistory.size() <= 4);
+    BOOST_CHECK(newtonSummary.linearHistory.size() < picardSummary.linearHistory.size());
+    for (size_t i = 0; i < newton.size(); ++i)
+        BOOST_CHECK_SMALL(newton[i] - picard[i], 2 * settings.residual);
+    Database::Shutdown();
+}
+
 test_suite * create_nano_heat_simulation_test_suite()
 {
     test_suite * simulation_suite = BOOST_TEST_SUITE("s_heat_simulation_test");
     //
     simulation_suite->add(BOOST_TEST_CASE(&t_prism_thermal_simulation_simple));
     simulation_suite->add(BOOST_TEST_CASE(&t_prism_thermal_simulation_wolfspeed));
+    simulation_suite->add(BOOST_TEST_CASE(&t_prism_thermal_network_deterministic));
+    simulation_suite->add(BOOST_TEST_CASE(&t_prism_thermal_network_warm_start));
+    simulation_suite->add(BOOST_TEST_CASE(&t_prism_thermal_network_newton));
     simulation_suite->add(BOOST_TEST_CASE(&t_prism_stackup_thermal_simulation_wolfspeed));
     // simulation_suite->add(BOOST_TEST_CASE(&t_prism_thermal_simulation2));
     //
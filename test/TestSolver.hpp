@@ -1,5 +1,19 @@
 #pragma once
 #include "TestCommon.hpp"
+#include "solver/network/NSThermalNetworkSuperposition.hpp"
+#include "solver/network/NSThermalNetworkOrdering.hpp"
+#include "solver/network/NSThermalNetworkMOR.hpp"
+#include "solver/network/NSThermalNetworkSolver.hpp"
+#include "solver/utils/NSAndersonMixing.hpp"
+#include "solver/utils/NSTransientResultWriter.hpp"
+
+#include <cstdio>
+#include <chrono>
+#include <random>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef NANO_APPLE_ACCELERATE_SUPPORT
 #include <Accelerate/Accelerate.h>
@@ -52,11 +66,880 @@ void t_apple_accelerate()
 #endif
 }
 
+namespace detail {
+
+/// nx x ny x nz grid network with strong vertical coupling, htc at bottom, heat at top and one fixed temperature node
+template <typename Scalar>
+inline nano::UPtr<nano::heat::solver::network::ThermalNetwork<Scalar>> CreateGridNetwork(size_t nx, size_t ny, size_t nz, Scalar anisotropy = 100)
+{
+    using namespace nano::heat::solver::network;
+    auto id = [&](size_t i, size_t j, size_t k) { return (k * ny + j) * nx + i; };
+    auto network = std::make_unique<ThermalNetwork<Scalar>>(nx * ny * nz);
+    for (size_t k = 0; k < nz; ++k) {
+        for (size_t j = 0; j < ny; ++j) {
+            for (size_t i = 0; i < nx; ++i) {
+                auto n = id(i, j, k);
+                network->SetC(n, 1);
+                if (i + 1 < nx) network->SetR(n, id(i + 1, j, k), 1 + 0.1 * (j % 3));
+                if (j + 1 < ny) network->SetR(n, id(i, j + 1, k), 1 + 0.1 * (i % 5));
+                if (k + 1 < nz) network->SetR(n, id(i, j, k + 1), 1 / anisotropy);
+                if (0 == k) network->SetHTC(n, 0.5);
+                if (k + 1 == nz && i < nx / 2 && j < ny / 2) network->SetHF(n, 1);
+            }
+        }
+    }
+    network->SetT(id(nx - 1, ny - 1, nz - 1), 300);
+    for (size_t j = 0; j < ny; ++j) {
+        for (size_t i = 0; i < nx; ++i) {
+            Vec<Index> column;
+            for (size_t k = nz; k-- > 0;) column.emplace_back(id(i, j, k));
+            network->AddColumn(column);
+        }
+    }
+    network->Finalize();
+    network->BuildIndexMap();
+    return network;
+}
+
+/// grid with temperature dependent power and conductance, built at temperatures T with their analytic slopes
+template <typename Scalar>
+inline nano::UPtr<nano::heat::solver::network::ThermalNetwork<Scalar>> CreateNonlinearGridNetwork(size_t n, size_t nz, const nano::Vec<Scalar> & T)
+{
+    using namespace nano::heat::solver::network;
+    auto id = [&](size_t i, size_t j, size_t k) { return (k * n + j) * n + i; };
+    auto k = [&](size_t node) { return Scalar(1) - Scalar(2e-3) * (T[node] - 300); };
+    auto network = std::make_unique<ThermalNetwork<Scalar>>(n * n * nz);
+    auto dr = [&](size_t node, Scalar r0) { return Scalar(0.5) * r0 * Scalar(2e-3) / (k(node) * k(node)); };
+    auto setR = [&](size_t n1, size_t n2, Scalar r0) {
+        network->SetR(n1, n2, Scalar(0.5) * r0 / k(n1) + Scalar(0.5) * r0 / k(n2), dr(n1, r0), dr(n2, r0));
+    };
+    for (size_t z = 0; z < nz; ++z) {
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < n; ++i) {
+                auto node = id(i, j, z);
+                if (i + 1 < n) setR(node, id(i + 1, j, z), 1);
+                if (j + 1 < n) setR(node, id(i, j + 1, z), 1);
+                if (z + 1 < nz) setR(node, id(i, j, z + 1), 0.1);
+                if (0 == z) network->SetHTC(node, 0.5);
+                if (z + 1 == nz && i < n / 2 && j < n / 2) {
+                    network->SetHF(node, Scalar(0.5) * (1 + Scalar(0.05) * (T[node] - 300)));
+                    network->AddSlope(node, Scalar(0.025));
+                }
+            }
+        }
+    }
+    network->Finalize();
+    network->BuildIndexMap();
+    return network;
+}
+
+} // namespace detail
+
+void t_thermal_network_csr()
+{
+    using namespace nano::heat::solver::network;
+    ThermalNetwork<Float64> network(4);
+    network.SetR(0, 1, 2);
+    network.SetR(1, 0, 2);//parallel
+    network.SetR(2, 1, 1);
+    network.SetR(2, 3, 1);
+    network.SetHF(0, 1);
+    network.SetT(3, 300);
+    network.Finalize();
+    network.BuildIndexMap();
+    BOOST_CHECK(network.EdgeSize() == 3);
+    BOOST_CHECK(network.Neighbors(1).size() == 2);
+    BOOST_CHECK(network.Neighbors(1)[0] == 0 && network.Neighbors(1)[1] == 2);
+    BOOST_CHECK_CLOSE(network.Conductances(0)[0], 1.0, 1e-12);
+
+    //heat flow changes after indexing keep the cached sources in matrix order
+    BOOST_CHECK(network.SourceSize() == 2 && INVALID_INDEX == network.SourceId(1));
+    network.SetHF(1, 1);
+    BOOST_CHECK(network.SourceSize() == 3 && network.SourceId(1) == 1 && network.SourceId(2) == 2);
+    network.SetHF(1, 0);
+    BOOST_CHECK(network.SourceSize() == 2 && network.SourceId(2) == 1);
+
+    Vec<Float64> results;
+    ThermalNetworkStaticSolver<Float64> solver;
+    solver.Solve(network, 300, results);
+    BOOST_CHECK_CLOSE(results[0], 303.0, 1e-6);
+    BOOST_CHECK_CLOSE(results[2], 301.0, 1e-6);
+}
+
+void t_thermal_network_preconditioners()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    auto network = detail::CreateGridNetwork<Float64>(12, 12, 6, 1e4);
+    using Preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner;
+
+    Vec<Float64> reference;
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-10;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(*network, 300, reference);
+
+    size_t jacobiIter = 0;
+    for (auto preconditioner : {Preconditioner::JACOBI, Preconditioner::INCOMPLETE_CHOLESKY, Preconditioner::SSOR, Preconditioner::AMG, Preconditioner::LINE}) {
+        settings.preconditioner = preconditioner;
+        Vec<Float64> results;
+        ThermalNetworkStaticSolver<Float64> solver(settings);
+        solver.Solve(*network, 300, results);
+        BOOST_CHECK(solver.Summary().converged);
+        BOOST_CHECK(solver.Summary().residual <= settings.tolerance);
+        if (Preconditioner::JACOBI == preconditioner) jacobiIter = solver.Summary().iterations;
+        else BOOST_CHECK(solver.Summary().iterations < jacobiIter);
+        for (size_t i = 0; i < results.size(); ++i)
+            BOOST_CHECK_SMALL(results[i] - reference[i], 1e-3);
+    }
+}
+
+void t_thermal_network_amg()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    using Smoother = ThermalNetworkLinearSolverSettings::Smoother;
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-8;
+    settings.amgCoarseSize = 50;
+    settings.preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner::AMG;
+    for (auto smoother : {Smoother::JACOBI, Smoother::CHEBYSHEV}) {
+        settings.amgSmoother = smoother;
+        Vec<size_t> iterations;
+        for (size_t n : {16, 32, 64}) {//iteration count should stay nearly flat under refinement
+            auto network = detail::CreateGridNetwork<Float64>(n, n, 4, 1e2);
+            Vec<Float64> results;
+            ThermalNetworkStaticSolver<Float64> solver(settings);
+            solver.Solve(*network, 300, results);
+            BOOST_CHECK(solver.Summary().converged);
+            iterations.emplace_back(solver.Summary().iterations);
+        }
+        BOOST_CHECK(iterations.back() < 2 * iterations.front());
+    }
+#ifdef _OPENMP
+    //aggregation runs in fixed row blocks, the hierarchy and so the iteration count do not depend on the thread count
+    auto network = detail::CreateGridNetwork<Float64>(64, 64, 4, 1e2);
+    auto iterations = [&](int threads) {
+        auto ompThreads = omp_get_max_threads();
+        omp_set_num_threads(threads);
+        Vec<Float64> results;
+        ThermalNetworkStaticSolver<Float64> solver(settings);
+        solver.Solve(*network, 300, results);
+        omp_set_num_threads(ompThreads);
+        return solver.Summary().iterations;
+    };
+    BOOST_CHECK(iterations(1) == iterations(4));
+#endif
+}
+
+void t_thermal_network_newton()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    const size_t n = 8, nz = 4;
+    const Float64 refT = 300, tolerance = 1e-6;
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-12;
+    settings.preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner::INCOMPLETE_CHOLESKY;
+    auto maxDiff = [](const Vec<Float64> & t1, const Vec<Float64> & t2) {
+        Float64 diff = 0;
+        for (size_t i = 0; i < t1.size(); ++i) diff = std::max(diff, std::fabs(t1[i] - t2[i]));
+        return diff;
+    };
+
+    size_t picardIter = 0;
+    Vec<Float64> picard(n * n * nz, refT), next;
+    ThermalNetworkStaticSolver<Float64> solver(settings);
+    for (; picardIter < 100; ++picardIter) {
+        solver.Solve(*detail::CreateNonlinearGridNetwork(n, nz, picard), refT, next);
+        std::swap(picard, next);
+        if (maxDiff(picard, next) < tolerance) break;
+    }
+
+    //full jacobian, quadratic convergence
+    size_t newtonIter = 0;
+    Vec<Float64> newton(n * n * nz, refT), dT;
+    for (; newtonIter < 10; ++newtonIter) {
+        solver.SolveNewton(*detail::CreateNonlinearGridNetwork(n, nz, newton), refT, newton, dT);
+        BOOST_CHECK(solver.Summary().converged);
+        for (size_t i = 0; i < newton.size(); ++i) newton[i] += dT[i];
+        if (*std::max_element(dT.begin(), dT.end(), [](auto a, auto b) { return std::fabs(a) < std::fabs(b); }) < tolerance) break;
+    }
+    BOOST_CHECK(newtonIter + 1 <= 4);
+    BOOST_CHECK(newtonIter < picardIter);
+    BOOST_CHECK_SMALL(maxDiff(newton, picard), 1e-4);
+    BOOST_CHECK_SMALL(makeResidual(*detail::CreateNonlinearGridNetwork(n, nz, newton), refT, newton).norm(), 1e-6);
+
+    //the configured solver still works after a newton solve
+    solver.Solve(*detail::CreateNonlinearGridNetwork(n, nz, newton), refT, next);
+    BOOST_CHECK(solver.Summary().iterations > 1);
+    BOOST_CHECK_SMALL(maxDiff(newton, next), 1e-4);
+}
+
+void t_thermal_network_anderson()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    const size_t n = 8, nz = 4;
+    const Float64 refT = 300, tolerance = 1e-6;
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-12;
+    settings.preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner::INCOMPLETE_CHOLESKY;
+    ThermalNetworkStaticSolver<Float64> solver(settings);
+    auto iterate = [&](size_t depth, Vec<Float64> & t) {
+        Vec<Float64> next;
+        nano::heat::solver::utils::AndersonMixing<Float64> anderson(std::max<size_t>(depth, 1));
+        for (size_t iter = 1; iter < 100; ++iter) {
+            solver.Solve(*detail::CreateNonlinearGridNetwork(n, nz, t), refT, next);
+            Float64 diff = 0;
+            for (size_t i = 0; i < t.size(); ++i) diff = std::max(diff, std::fabs(t[i] - next[i]));
+            if (depth > 0) anderson.Update(t, next);
+            std::swap(t, next);
+            if (diff < tolerance) return iter;
+        }
+        return size_t(100);
+    };
+    Vec<Float64> picard(n * n * nz, refT), anderson(n * n * nz, refT);
+    auto picardIter = iterate(0, picard);
+    auto andersonIter = iterate(3, anderson);
+    BOOST_CHECK(andersonIter < picardIter);
+    for (size_t i = 0; i < picard.size(); ++i)
+        BOOST_CHECK_SMALL(picard[i] - anderson[i], 1e-4);
+}
+
+void t_thermal_network_batch()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    auto network = detail::CreateGridNetwork<Float64>(8, 8, 4, 1e2);
+    const size_t cases = 5;
+    DenseMatrix<Float64> hf(network->NodeSize(), cases), results;
+    for (size_t i = 0; i < network->NodeSize(); ++i)
+        for (size_t c = 0; c < cases; ++c)
+            hf(i, c) = (*network)[i].hf * (c + 1) + (i % (c + 2) == 0 ? 0.1 : 0);
+
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-10;
+    for (auto solverType : {ThermalNetworkLinearSolverSettings::Solver::CG, ThermalNetworkLinearSolverSettings::Solver::LDLT}) {
+        settings.solver = solverType;
+        ThermalNetworkStaticSolver<Float64> solver(settings);
+        solver.Solve(*network, 300, hf, results);
+        BOOST_CHECK(solver.Summary().converged);
+        for (size_t c = 0; c < cases; ++c) {
+            auto single = *network;
+            for (size_t i = 0; i < single.NodeSize(); ++i) single.SetHF(i, hf(i, c));
+            Vec<Float64> reference;
+            ThermalNetworkStaticSolver<Float64>(settings).Solve(single, 300, reference);
+            for (size_t i = 0; i < reference.size(); ++i)
+                BOOST_CHECK_CLOSE(results(i, c), reference[i], 1e-6);
+        }
+    }
+}
+
+void t_thermal_network_superposition()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    auto network = detail::CreateGridNetwork<Float64>(8, 8, 4, 1e2);
+    for (size_t i = 0; i < network->NodeSize(); ++i)
+        if (0 != (*network)[i].hf) { network->SetScenario(i, i % 3); network->SetPower(i, (*network)[i].hf); }
+    for (size_t i = 0; i < network->NodeSize(); ++i) {
+        //boundary heat flux on a powered node is not scaled
+        if (1 == network->GetScenario(i)) { network->AddHF(i, 0.05); break; }
+    }
+    Vec<Index> probes{0, 17, 100, 255};
+
+    ThermalNetworkLinearSolverSettings settings;
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    ThermalNetworkSuperposition<Float64> superposition;
+    superposition.Build(*network, 300, probes, settings);
+    BOOST_CHECK(superposition.SourceSize() == 3);
+    BOOST_CHECK(superposition.ProbeSize() == probes.size());
+
+    //nominal power reproduces the full solve, scaled power matches a solve with scaled heat flow
+    DenseVector<Float64> power = superposition.nominal, temperatures;
+    for (auto scale : {1.0, 2.5}) {
+        power[1] = superposition.nominal[1] * scale;
+        superposition.Evaluate(power, temperatures);
+        auto scaled = *network;
+        for (size_t i = 0; i < scaled.NodeSize(); ++i)
+            if (scaled[i].scen == superposition.sources[1]) scaled.SetHF(i, scaled[i].hf + scaled[i].power * (scale - 1));
+        Vec<Float64> reference;
+        ThermalNetworkStaticSolver<Float64>(settings).Solve(scaled, 300, reference);
+        for (size_t p = 0; p < probes.size(); ++p)
+            BOOST_CHECK_CLOSE(temperatures[p], reference[probes[p]], 1e-8);
+    }
+}
+
+void t_thermal_network_adjoint()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    auto network = detail::CreateGridNetwork<Float64>(8, 8, 4, 1e2);
+    for (size_t i = 0; i < network->NodeSize(); ++i)
+        if (0 != (*network)[i].hf) { network->SetScenario(i, i % 5); network->SetPower(i, (*network)[i].hf); }
+    Vec<Index> probes{3, 200};
+    ThermalNetworkLinearSolverSettings settings;
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    ThermalNetworkStaticSolver<Float64> solver(settings);
+
+    //transfer against forward unit responses
+    DenseMatrix<Float64> transfer, hf(network->NodeSize(), 3), results;
+    solver.SolveAdjoint(*network, probes, transfer);
+    BOOST_CHECK(size_t(transfer.rows()) == probes.size() && size_t(transfer.cols()) == network->SourceSize());
+    const auto & sources = network->Sources();
+    for (size_t i = 0; i < network->NodeSize(); ++i) hf.row(i).setConstant((*network)[i].hf);
+    hf(sources.front(), 1) += 1;
+    hf(sources.back(), 2) += 1;
+    solver.Solve(*network, 300, hf, results);
+    for (size_t p = 0; p < probes.size(); ++p) {
+        BOOST_CHECK_CLOSE(transfer(p, 0), results(probes[p], 1) - results(probes[p], 0), 1e-6);
+        BOOST_CHECK_CLOSE(transfer(p, sources.size() - 1), results(probes[p], 2) - results(probes[p], 0), 1e-6);
+    }
+
+    //superposition takes the adjoint path with fewer probes than sources
+    ThermalNetworkSuperposition<Float64> adjoint, forward;
+    adjoint.Build(*network, 300, probes, settings);
+    forward.Build(*network, 300, {3, 200, 3, 200, 3, 200}, settings);
+    for (size_t s = 0; s < adjoint.SourceSize(); ++s)
+        for (size_t p = 0; p < probes.size(); ++p)
+            BOOST_CHECK_CLOSE(adjoint.influence(s, p), forward.influence(s, p), 1e-6);
+}
+
+void t_thermal_network_matrix_free()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    using Preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner;
+    auto network = detail::CreateGridNetwork<Float64>(12, 12, 6, 1e3);
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-10;
+    for (auto preconditioner : {Preconditioner::JACOBI, Preconditioner::LINE}) {
+        settings.preconditioner = preconditioner;
+        Vec<Float64> reference, results;
+        settings.matrixFree = false;
+        ThermalNetworkStaticSolver<Float64> assembled(settings);
+        assembled.Solve(*network, 300, reference);
+        settings.matrixFree = true;
+        ThermalNetworkStaticSolver<Float64> matrixFree(settings);
+        matrixFree.Solve(*network, 300, results);
+        BOOST_CHECK(matrixFree.Summary().converged);
+        BOOST_CHECK(std::abs(int(matrixFree.Summary().iterations) - int(assembled.Summary().iterations)) <= 2);
+        for (size_t i = 0; i < results.size(); ++i)
+            BOOST_CHECK_CLOSE(results[i], reference[i], 1e-6);
+
+        //the operator is owned by the linear solver and survives a move of the static solver
+        auto moved = std::move(matrixFree);
+        moved.Solve(*network, 300, results);
+        BOOST_CHECK(moved.Summary().converged);
+        for (size_t i = 0; i < results.size(); ++i)
+            BOOST_CHECK_CLOSE(results[i], reference[i], 1e-6);
+    }
+}
+
+void t_thermal_network_direct_solver()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    auto network = detail::CreateGridNetwork<Float64>(12, 12, 6, 1e4);
+
+    Vec<Float64> reference, results;
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-10;
+    settings.preconditioner = ThermalNetworkLinearSolverSettings::Preconditioner::INCOMPLETE_CHOLESKY;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(*network, 300, reference);
+
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    ThermalNetworkStaticSolver<Float64> solver(settings);
+    for (size_t i = 0; i < 2; ++i) {//second solve reuses symbolic analysis
+        solver.Solve(*network, 300, results);
+        BOOST_CHECK(solver.Summary().converged);
+        BOOST_CHECK(solver.Summary().residual < 1e-10);
+    }
+    for (size_t i = 0; i < results.size(); ++i)
+        BOOST_CHECK_SMALL(results[i] - reference[i], 1e-3);
+
+    //a singular matrix fails the solve instead of returning garbage
+    SparseMatrix<Float64> G(2, 2);
+    G.insert(0, 0) = 1; G.insert(0, 1) = -1;
+    G.insert(1, 0) = -1; G.insert(1, 1) = 1;
+    G.makeCompressed();
+    DenseVector<Float64> b(2), x;
+    b << 1, 0;
+    auto ldlt = CreateLinearSolver<Float64>(settings);
+    ldlt->Analyze(G);
+    ldlt->Factorize(G);
+    BOOST_CHECK(not ldlt->Solve(b, x, false));
+    BOOST_CHECK(not ldlt->summary.converged && x.size() == 2 && x.isZero());
+}
+
+void t_thermal_network_schur()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    auto network = detail::CreateGridNetwork<Float64>(16, 16, 6, 1e4);
+
+    Vec<Float64> reference, results;
+    ThermalNetworkLinearSolverSettings settings;
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(*network, 300, reference);
+
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::SCHUR;
+    settings.tolerance = 1e-10;
+    for (size_t subdomains : {1, 4, 7, 16}) {
+        settings.subdomains = subdomains;
+        ThermalNetworkStaticSolver<Float64> solver(settings);
+        for (size_t i = 0; i < 2; ++i) {//second solve reuses partition and symbolic factorizations
+            solver.Solve(*network, 300, results);
+            BOOST_CHECK(solver.Summary().converged);
+            BOOST_CHECK(solver.Summary().residual < 1e-10);
+        }
+        for (size_t i = 0; i < results.size(); ++i)
+            BOOST_CHECK_SMALL(results[i] - reference[i], 1e-4);
+    }
+
+    //value changes on the same topology are refilled into the blocks of the first analysis
+    auto changed = *network;
+    for (size_t i = 0; i < changed.NodeSize(); i += 3) changed.SetHTC(i, changed.GetHTC(i) * 2 + 0.1);
+    settings.subdomains = 4;
+    ThermalNetworkStaticSolver<Float64> solver(settings);
+    solver.Solve(*network, 300, results);
+    solver.Solve(changed, 300, results);
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(changed, 300, reference);
+    BOOST_CHECK(solver.Summary().converged);
+    for (size_t i = 0; i < results.size(); ++i)
+        BOOST_CHECK_SMALL(results[i] - reference[i], 1e-4);
+
+    //parts of the grid graph are balanced and cover all rows
+    SparseMatrix<Float64> G;
+    ConductancePattern<Float64> pattern;
+    pattern.Analyze(*network, G);
+    auto part = dd::Partition(G, 8);
+    Vec<size_t> sizes(8, 0);
+    for (auto p : part) sizes.at(p)++;
+    for (auto size : sizes)
+        BOOST_CHECK(size + 1 >= G.rows() / 8 && size <= G.rows() / 8 + 1);
+}
+
+void t_thermal_network_sell()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    auto network = detail::CreateGridNetwork<Float64>(12, 12, 6, 1e3);
+    ThermalNetworkLinearSolverSettings settings;
+    settings.tolerance = 1e-10;
+    Vec<Float64> reference, results;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(*network, 300, reference);
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::SELL_CG;
+    for (bool pipelined : {false, true}) {
+        settings.pipelined = pipelined;
+        ThermalNetworkStaticSolver<Float64> solver(settings);
+        solver.Solve(*network, 300, results);
+        BOOST_CHECK(solver.Summary().converged);
+        //the pipelined recurrences drift from the true residual, so its results are checked looser
+        auto tolerance = pipelined ? 1e-5 : 1e-6;
+        for (size_t i = 0; i < results.size(); ++i)
+            BOOST_CHECK_CLOSE(results[i], reference[i], tolerance);
+    }
+
+    //y = G x against eigen
+    SparseMatrix<Float64> G;
+    ConductancePattern<Float64> pattern;
+    pattern.Analyze(*network, G);
+    pattern.Fill(*network, G);
+    SellMatrix<Float64> A;
+    A.Analyze(G, settings.sellSigma);
+    DenseVector<Float64> x = DenseVector<Float64>::Random(G.rows()), y1, y2;
+    y1 = G * x;
+    A.Multiply(x, y2);
+    BOOST_CHECK_SMALL((y1 - y2).norm() / y1.norm(), 1e-14);
+
+#ifdef NANO_BENCHMARK
+    //microbenchmark of y = G x, effective bandwidth counts values, column indices, x and y once
+    auto grid = detail::CreateGridNetwork<Float64>(128, 128, 16);
+    pattern.Analyze(*grid, G);
+    pattern.Fill(*grid, G);
+    A.Analyze(G, settings.sellSigma);
+    x = DenseVector<Float64>::Random(G.rows());
+    constexpr size_t repeats = 20;
+    auto bytes = double(G.nonZeros()) * (sizeof(Float64) + sizeof(int)) + 2.0 * G.rows() * sizeof(Float64);
+    auto time = [&](auto && spmv) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repeats; ++i) spmv();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+    };
+    auto tEigen = time([&]{ y1.noalias() = G * x; });
+    auto tSell = time([&]{ A.Multiply(x, y2); });
+    NS_TRACE("spmv rows: %1%, nnz: %2%, eigen: %3% GB/s, sell: %4% GB/s", G.rows(), G.nonZeros(), bytes / tEigen * 1e-9, bytes / tSell * 1e-9);
+#endif//NANO_BENCHMARK
+}
+
+void t_thermal_network_mixed_precision()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    using Solver = ThermalNetworkLinearSolverSettings::Solver;
+    auto network = detail::CreateGridNetwork<Float64>(12, 12, 6, 1e4);
+
+    Vec<Float64> reference, results;
+    ThermalNetworkLinearSolverSettings settings;
+    settings.solver = Solver::LDLT;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(*network, 300, reference);
+
+    settings.mixedPrecision = true;
+    settings.tolerance = 1e-12;
+    for (auto solver : {Solver::LDLT, Solver::CG}) {
+        settings.solver = solver;
+        ThermalNetworkStaticSolver<Float64> mixed(settings);
+        mixed.Solve(*network, 300, results);
+        BOOST_CHECK(mixed.Summary().converged);
+        BOOST_CHECK(mixed.Summary().residual <= 1e-12);
+        for (size_t i = 0; i < results.size(); ++i)
+            BOOST_CHECK_SMALL(results[i] - reference[i], 1e-6);
+    }
+
+    //transient steps refine their C / h + G solves the same way
+    using Method = ThermalNetworkTransientSolverSettings::Method;
+    auto on = [](Float, ScenarioId) -> Float { return 1; };
+    Vec<Float64> T0(network->NodeSize(), 300);
+    auto transient = [&](bool mixed) {
+        ThermalNetworkTransientSolverSettings settings;
+        settings.method = Method::CRANK_NICOLSON;
+        settings.linearSettings.solver = Solver::LDLT;
+        settings.linearSettings.mixedPrecision = mixed;
+        settings.linearSettings.tolerance = 1e-12;
+        ThermalNetworkTransientSolver<Float64> solver(settings);
+        solver.Initialize(*network, 300, T0, on);
+        for (size_t s = 0; s < 10; ++s) {
+            BOOST_CHECK(solver.Step(0.1));
+            BOOST_CHECK(solver.Summary().residual <= 1e-12);
+        }
+        Vec<Float64> T;
+        solver.Temperatures(T);
+        return T;
+    };
+    reference = transient(false);
+    results = transient(true);
+    for (size_t i = 0; i < results.size(); ++i)
+        BOOST_CHECK_SMALL(results[i] - reference[i], 1e-6);
+}
+
+void t_thermal_network_ordering()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    const size_t nx = 12, ny = 12, nz = 6;
+    auto network = detail::CreateGridNetwork<Float64>(nx, ny, nz, 1e3);
+    Vec<Arr3<Float>> points(network->NodeSize());
+    for (size_t n = 0; n < points.size(); ++n)
+        points[n] = {Float(n % nx), Float(n / nx % ny), Float(n / nx / ny)};
+
+    ThermalNetworkLinearSolverSettings settings;
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    Vec<Float64> reference, results;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(*network, 300, reference);
+    auto natural = makeOrderingReport(*network);
+
+    //scrambled matrix order, every ordering recovers locality and keeps the solution
+    Vec<Index> scramble(network->MatrixSize());
+    std::iota(scramble.begin(), scramble.end(), 0);
+    std::shuffle(scramble.begin(), scramble.end(), std::mt19937(0));
+    auto topology = network->Topology();
+    network->Reorder(scramble);
+    BOOST_CHECK(topology != network->Topology());
+    auto scrambled = makeOrderingReport(*network);
+    BOOST_CHECK(scrambled.profile > natural.profile);
+
+    auto fill = [&] {
+        SparseMatrix<Float64> G;
+        ConductancePattern<Float64> pattern;
+        pattern.Analyze(*network, G);
+        pattern.Fill(*network, G);
+        Eigen::SimplicialLDLT<SparseMatrix<Float64>, Eigen::Lower, Eigen::NaturalOrdering<int>> ldlt(G);
+        return ldlt.matrixL().nestedExpression().nonZeros();
+    };
+    auto scrambledFill = fill();
+    for (size_t method = 0; method < 3; ++method) {
+        network->Reorder(scramble);//any permutation of the current order
+        auto order = 0 == method ? makeRCMOrdering(*network) : 1 == method ? makeHilbertOrdering(*network, points) : makeNestedDissectionOrdering(*network);
+        Vec<bool> seen(order.size(), false);
+        for (auto mid : order) seen.at(mid) = true;
+        BOOST_CHECK(std::all_of(seen.begin(), seen.end(), [](bool b) { return b; }));
+        network->Reorder(order);
+        auto report = makeOrderingReport(*network);
+        BOOST_CHECK(report.bandwidth < scrambled.bandwidth && report.profile < scrambled.profile);
+        BOOST_CHECK(fill() < scrambledFill);
+        ThermalNetworkStaticSolver<Float64>(settings).Solve(*network, 300, results);
+        for (size_t i = 0; i < results.size(); ++i)
+            BOOST_CHECK_CLOSE(results[i], reference[i], 1e-8);
+    }
+
+    //the node order guess lands on the matrix rows of its nodes, the solution as guess leaves no CG work
+    auto cg = settings;
+    cg.solver = ThermalNetworkLinearSolverSettings::Solver::CG;
+    cg.tolerance = 1e-6;
+    ThermalNetworkStaticSolver<Float64> solver(cg);
+    solver.Solve(*network, 300, results);
+    auto cold = solver.Summary().iterations;
+    BOOST_CHECK(cold > 0);
+    solver.Solve(*network, 300, results, &reference);
+    BOOST_CHECK(solver.Summary().converged);
+    BOOST_CHECK(solver.Summary().iterations == 0);
+    auto guess = reference;
+    for (auto & t : guess) t += 1e-3 * (t - 300);
+    solver.Solve(*network, 300, results, &guess);
+    BOOST_CHECK(solver.Summary().iterations < cold);
+}
+
+void t_thermal_network_condensation()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    //top layer of a grid bridged by wire chains with joule heat, one chain ends at a fixed temperature node, one dangles
+    const size_t n = 8, nz = 3, segments = 10, wires = 6;
+    auto id = [&](size_t i, size_t j, size_t k) { return (k * n + j) * n + i; };
+    const size_t grid = n * n * nz;
+    ThermalNetwork<Float64> network(grid + 1 + wires * segments);
+    for (size_t k = 0; k < nz; ++k) {
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < n; ++i) {
+                if (i + 1 < n) network.SetR(id(i, j, k), id(i + 1, j, k), 1);
+                if (j + 1 < n) network.SetR(id(i, j, k), id(i, j + 1, k), 1);
+                if (k + 1 < nz) network.SetR(id(i, j, k), id(i, j, k + 1), 0.1);
+                if (0 == k) network.SetHTC(id(i, j, k), 0.5);
+            }
+        }
+    }
+    const Index fixed = grid;
+    network.SetT(fixed, 350);
+    for (size_t w = 0; w < wires; ++w) {
+        Index prev = id(w, 0, nz - 1), node = grid + 1 + w * segments;
+        for (size_t s = 0; s < segments; ++s, prev = node++) {
+            network.SetR(prev, node, 0.2 + 0.01 * s);
+            network.SetHF(node, 0.1 * (w + 1));
+        }
+        if (0 == w) network.SetR(prev, fixed, 0.3);
+        else if (w + 1 < wires) network.SetR(prev, id(w, n - 1, nz - 1), 0.3);
+    }
+    network.Finalize();
+    network.BuildIndexMap();
+
+    ThermalNetworkLinearSolverSettings settings;
+    settings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    Vec<Float64> reference, results;
+    ThermalNetworkStaticSolver<Float64>(settings).Solve(network, 300, reference);
+
+    ThermalNetworkStaticSolver<Float64> solver(settings);
+    solver.SetCondensation(true);
+    solver.Solve(network, 300, results);
+    for (size_t i = 0; i < results.size(); ++i)
+        BOOST_CHECK_CLOSE(results[i], reference[i], 1e-8);
+
+    ChainCondensation<Float64> condensation;
+    condensation.Analyze(network);
+    BOOST_CHECK(condensation.ChainSize() == wires);
+    BOOST_CHECK(condensation.InteriorSize() == wires * segments - 1);//the dangling end is a leaf node
+    auto reduced = condensation.Condense(network);
+    BOOST_CHECK(reduced->MatrixSize() + condensation.InteriorSize() == network.MatrixSize());
+}
+
+void t_thermal_network_transient()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    using Method = ThermalNetworkTransientSolverSettings::Method;
+    auto network = detail::CreateGridNetwork<Float64>(6, 6, 3, 10);
+    Index flux{INVALID_INDEX};
+    for (size_t i = 0; i < network->NodeSize(); ++i) {
+        if (0 == (*network)[i].hf) continue;
+        network->SetScenario(i, 0);
+        network->SetPower(i, (*network)[i].hf);
+        if (INVALID_INDEX == flux) flux = i;
+    }
+    network->AddHF(flux, 0.2);//boundary heat flux is not switched with the power
+    ThermalNetworkTransientSolverSettings settings;
+    settings.linearSettings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    Vec<Float64> steady, fluxOnly, T0(network->NodeSize(), 300), T;
+    ThermalNetworkStaticSolver<Float64>(settings.linearSettings).Solve(*network, 300, steady);
+    auto unpowered = *network;
+    for (size_t i = 0; i < unpowered.NodeSize(); ++i) unpowered.SetHF(i, unpowered[i].hf - unpowered[i].power);
+    ThermalNetworkStaticSolver<Float64>(settings.linearSettings).Solve(unpowered, 300, fluxOnly);
+
+    auto run = [&](Method method, Float64 dt, Float64 duration, auto excitation) {
+        settings.method = method;
+        ThermalNetworkTransientSolver<Float64> solver(settings);
+        solver.Initialize(*network, 300, T0, excitation);
+        while (duration - solver.Time() > 1e-6 * dt)
+            BOOST_CHECK(solver.Step(std::min(dt, duration - solver.Time())));
+        BOOST_CHECK(solver.Factorizations() == 1);
+        solver.Temperatures(T);
+        return T;
+    };
+    auto on = [](Float, ScenarioId) -> Float { return 1; };
+    auto off = [](Float, ScenarioId) -> Float { return 0; };
+    auto pulse = [](Float t, ScenarioId) -> Float { return t < 1 ? 1 : 0; };
+
+    //long constant power reaches the static solution, with power off only the boundary heat flux remains
+    auto longRun = run(Method::BACKWARD_EULER, 1, 500, on);
+    for (size_t i = 0; i < steady.size(); ++i)
+        BOOST_CHECK_CLOSE(longRun[i], steady[i], 1e-6);
+    longRun = run(Method::BACKWARD_EULER, 1, 500, off);
+    for (size_t i = 0; i < fluxOnly.size(); ++i)
+        BOOST_CHECK_CLOSE(longRun[i], fluxOnly[i], 1e-6);
+
+    //crank nicolson is closer than backward euler to a fine reference, the pulse is switched off at t = 1
+    auto reference = run(Method::CRANK_NICOLSON, 1e-3, 2, pulse);
+    Float64 errBE{0}, errCN{0};
+    auto be = run(Method::BACKWARD_EULER, 0.05, 2, pulse);
+    auto cn = run(Method::CRANK_NICOLSON, 0.05, 2, pulse);
+    for (size_t i = 0; i < reference.size(); ++i) {
+        errBE = std::max(errBE, std::fabs(be[i] - reference[i]));
+        errCN = std::max(errCN, std::fabs(cn[i] - reference[i]));
+    }
+    BOOST_CHECK(errCN < errBE);
+    BOOST_CHECK(*std::max_element(reference.begin(), reference.end()) < *std::max_element(steady.begin(), steady.end()));
+
+    //adaptive TR-BDF2 from a fine initial step across the switching edge, against the fine fixed step reference
+    const Float64 duration = 3, fine = 1e-4;
+    reference = run(Method::CRANK_NICOLSON, fine, duration, pulse);
+    settings.method = Method::TR_BDF2;
+    settings.step = fine;
+    settings.tolerance = 1e-3;
+    ThermalNetworkTransientSolver<Float64> adaptive(settings);
+    adaptive.Initialize(*network, 300, T0, pulse);
+    size_t steps{0};
+    for (Float64 dt = settings.step; duration - adaptive.Time() > 1e-6 * dt; ++steps) {
+        adaptive.Advance(std::min(dt, duration - adaptive.Time()), dt);
+        //both stages of every attempt are counted
+        BOOST_CHECK(adaptive.StepSummary().iterations >= 2 * adaptive.Summary().iterations);
+    }
+    adaptive.Temperatures(T);
+    Float64 error{0};
+    for (size_t i = 0; i < T.size(); ++i)
+        error = std::max(error, std::fabs(T[i] - reference[i]));
+    BOOST_CHECK(error < 10 * settings.tolerance);
+    BOOST_CHECK(steps * 100 < duration / fine);
+}
+
+void t_thermal_network_reduced_order()
+{
+    using namespace nano::heat;
+    using namespace nano::heat::solver::network;
+    using Method = ThermalNetworkTransientSolverSettings::Method;
+    auto network = detail::CreateGridNetwork<Float64>(6, 6, 3, 10);
+    Vec<Index> probes;
+    for (size_t i = 0; i < network->NodeSize(); ++i) {
+        if (0 != (*network)[i].hf) { network->SetScenario(i, i % 2); network->SetPower(i, (*network)[i].hf); }
+        if (0 == i % 17 || (*network)[i].t != network->UNKNOWN_T) probes.emplace_back(i);
+    }
+    ThermalNetworkTransientSolverSettings settings;
+    settings.linearSettings.solver = ThermalNetworkLinearSolverSettings::Solver::LDLT;
+    settings.method = Method::CRANK_NICOLSON;
+    auto excitation = [](Float t, ScenarioId scen) -> Float {
+        return 0 == scen ? 0.5 + 0.5 * std::sin(2 * generic::math::pi * t) : std::min<Float>(t, 1);
+    };
+
+    //fine crank nicolson reference of the full network
+    const Float64 duration = 2, dt = 1e-3;
+    Vec<Float64> T0(network->NodeSize(), 300);
+    ThermalNetworkTransientSolver<Float64> full(settings);
+    full.Initialize(*network, 300, T0, excitation);
+    while (duration - full.Time() > 1e-6 * dt)
+        BOOST_CHECK(full.Step(std::min(dt, duration - full.Time())));
+
+    auto error = [&](size_t order) {
+        ThermalNetworkReducedModel<Float64> model;
+        model.Build(*network, 300, 300, probes, order, settings.linearSettings);
+        BOOST_CHECK(model.isValid(*network, 300, 300, probes, order));
+        BOOST_CHECK(model.PortSize() == 3);
+        Float64 err{0};
+        model.Simulate(excitation, duration, 0.01, [&](Float64 time, const auto & y) {
+            if (duration - time > 1e-6) return;
+            for (size_t p = 0; p < probes.size(); ++p)
+                err = std::max(err, std::fabs(y[p] - full.Temperature(probes[p])));
+        });
+        return err;
+    };
+    //the full Krylov space is exact up to the reference error, a small order stays close
+    BOOST_CHECK(error(network->MatrixSize()) < 1e-5);
+    BOOST_CHECK(error(12) < 5e-3);
+
+    //the model is stale once a value behind G, C or B changes
+    ThermalNetworkReducedModel<Float64> model;
+    model.Build(*network, 300, 300, probes, 12, settings.linearSettings);
+    BOOST_CHECK(not model.isValid(*network, 300, 310, probes, 12));
+    network->SetC(probes.front(), 2 * network->GetC(probes.front()));
+    BOOST_CHECK(not model.isValid(*network, 300, 300, probes, 12));
+}
+
+void t_transient_result_writer()
+{
+    using namespace nano::heat::solver::utils;
+    const size_t probes = 3, nodes = 50, steps = 1000, interval = 100;
+    auto value = [](size_t step, size_t i) { return Float32(300 + 0.01 * step + i); };
+    auto filename = std::string(nano::CurrentDir()) + "/t_transient_result_writer.bin";
+    {
+        //small chunks and queue force recycling and back pressure
+        TransientResultWriter writer(filename, probes, nodes, interval, 64, 2);
+        BOOST_CHECK(writer.isOpen());
+        Vec<Float64> row(probes), field(nodes);
+        for (size_t s = 0; s < steps; ++s) {
+            for (size_t p = 0; p < probes; ++p) row[p] = value(s, p);
+            for (size_t i = 0; i < nodes; ++i) field[i] = value(s, i);
+            writer.Append(1e-3 * s, row, writer.NeedField() ? &field : nullptr);
+        }
+        BOOST_CHECK(writer.Close());
+    }
+    {
+        //the reader keeps the file open until it goes out of scope
+        TransientResultReader reader;
+        BOOST_CHECK(reader.Open(filename));
+        BOOST_CHECK(reader.Steps() == steps);
+        Vec<Float64> times;
+        Vec<Vec<Float32>> waveforms;
+        BOOST_CHECK(reader.ReadProbes(times, waveforms));
+        BOOST_CHECK(waveforms.size() == probes);
+        for (size_t s = 0; s < steps; ++s) {
+            BOOST_CHECK(times[s] == 1e-3 * s);
+            for (size_t p = 0; p < probes; ++p)
+                BOOST_CHECK(waveforms[p][s] == value(s, p));
+        }
+        auto snapshots = reader.Snapshots();
+        BOOST_CHECK(snapshots.size() == steps / interval);
+        Float64 time{0};
+        Vec<Float32> T;
+        BOOST_CHECK(reader.ReadField(snapshots.back(), time, T));
+        BOOST_CHECK(time == 1e-3 * snapshots.back());
+        for (size_t i = 0; i < nodes; ++i)
+            BOOST_CHECK(T[i] == value(snapshots.back(), i));
+        BOOST_CHECK(not reader.ReadField(1, time, T));
+    }
+    BOOST_CHECK(0 == std::remove(filename.c_str()));
+}
+
 test_suite * create_nano_heat_solver_test_suite()
 {
     test_suite * solver_suite = BOOST_TEST_SUITE("s_heat_solver_test");
     //
     solver_suite->add(BOOST_TEST_CASE(&t_apple_accelerate));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_csr));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_preconditioners));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_amg));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_direct_solver));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_batch));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_superposition));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_adjoint));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_matrix_free));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_schur));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_sell));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_mixed_precision));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_ordering));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_condensation));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_transient));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_reduced_order));
+    solver_suite->add(BOOST_TEST_CASE(&t_transient_result_writer));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_newton));
+    solver_suite->add(BOOST_TEST_CASE(&t_thermal_network_anderson));
     //
     return solver_suite;
 }
\ No newline at end of file